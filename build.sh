@@ -1,23 +1,60 @@
 #!/usr/bin/env bash
 # build.sh — Build GPU-accelerated Snake
+#   ./build.sh           core library, headless tools and the game
+#   ./build.sh headless  core library and headless tools only (no GL needed)
 set -e
 
 OS=$(uname)
-SRC="src/main.cpp src/game/Levels.cpp src/game/Game.cpp src/render/Render.cpp"
+CORE="src/game/LevelPack.cpp src/game/Levels.cpp src/game/Game.cpp src/game/MoveLog.cpp src/game/Sim.cpp \
+  src/game/SimLoop.cpp"
+SOLVER="src/solver/Heuristic.cpp src/solver/Solver.cpp"
+SRC="src/main.cpp src/render/Render.cpp src/render/SpriteSheet.cpp \
+  src/render/SvgCache.cpp src/render/Profiler.cpp \
+  src/render/Latency.cpp"
 OUT=snake_puzzle
+CXX_BIN=g++
+[ "$OS" = "Darwin" ] && CXX_BIN=clang++
+
+build_core() {
+  echo "[core] Building libsnake_core.a and the headless tools..."
+  mkdir -p build/obj
+  OBJS=""
+  for f in $CORE $SOLVER; do
+    o="build/obj/$(basename "${f%.cpp}").o"
+    $CXX_BIN -Isrc -std=c++17 -O2 -c "$f" -o "$o"
+    OBJS="$OBJS $o"
+  done
+  ar rcs build/libsnake_core.a $OBJS
+  $CXX_BIN -Isrc src/tools/headless.cpp build/libsnake_core.a \
+    -o snake_headless -std=c++17 -O2
+  $CXX_BIN -Isrc src/tools/bench.cpp build/libsnake_core.a \
+    -o snake_bench -std=c++17 -O2
+  $CXX_BIN -Isrc src/tools/pack.cpp build/libsnake_core.a \
+    -o snake_pack -std=c++17 -O2
+  $CXX_BIN -Isrc src/tools/solve.cpp build/libsnake_core.a \
+    -o snake_solve -std=c++17 -O2 -pthread
+  $CXX_BIN -Isrc src/tools/validate.cpp build/libsnake_core.a \
+    -o snake_validate -std=c++17 -O2 -pthread
+}
+
+build_core
+if [ "$1" = "headless" ]; then
+  echo "Done. Run with: ./snake_headless <level> [moves]"
+  exit 0
+fi
 
 if [ "$OS" = "Linux" ]; then
   echo "[Linux] Building with g++..."
-  g++ -Isrc $SRC -o $OUT \
-    -std=c++17 -O2 \
+  g++ -Isrc $SRC build/libsnake_core.a -o $OUT \
+    -std=c++17 -O2 -pthread \
     -lGL -lGLEW -lglfw \
     $(pkg-config --cflags glm 2>/dev/null || true)
   echo "Done. Run with: ./$OUT"
 
 elif [ "$OS" = "Darwin" ]; then
   echo "[macOS] Building with clang++..."
-  clang++ -Isrc $SRC -o $OUT \
-    -std=c++17 -O2 \
+  clang++ -Isrc $SRC build/libsnake_core.a -o $OUT \
+    -std=c++17 -O2 -pthread \
     -framework OpenGL \
     $(pkg-config --cflags --libs glfw3 glew 2>/dev/null || \
       echo "-I/opt/homebrew/include -L/opt/homebrew/lib -lglfw -lGLEW")
@@ -25,5 +62,5 @@ elif [ "$OS" = "Darwin" ]; then
 
 else
   echo "Windows: Use CMakeLists.txt or compile manually:"
-  echo "  cl -Isrc src/*.cpp src/*/*.cpp /std:c++17 /O2 opengl32.lib glew32.lib glfw3.lib"
-fi
\ No newline at end of file
+  echo "  cl -Isrc $CORE $SRC /std:c++17 /O2 opengl32.lib glew32.lib glfw3.lib"
+fi
@@ -0,0 +1,167 @@
+#pragma once
+#include "Core.h"
+#include <cstdint>
+#include <cstring>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// ─── Bitboards ───────────────────────────────────────────────────────────────
+// Fixed-size, heap-free board representation for the simulation hot path.
+// Boards are column-major: each of the MG columns is one 32-bit word and row y
+// lives at bit (MG - y), so "one row down" is a right shift by one. Bit 0 is
+// the row just below a full-height board and the high bits hold the rows just
+// above the top, which the snake can reach on the infinite map.
+constexpr int bitRow(int y) { return MG - y; }
+// True if a BitCols has a bit for (x, y)
+constexpr bool inCols(int x, int y) {
+  return x >= 0 && x < MG && bitRow(y) >= 0 && bitRow(y) < 32;
+}
+
+// Index of the highest / lowest set bit; v must be non-zero.
+inline int hiBit(uint32_t v) {
+#if defined(_MSC_VER)
+  unsigned long i;
+  _BitScanReverse(&i, v);
+  return (int)i;
+#else
+  return 31 - __builtin_clz(v);
+#endif
+}
+inline int loBit(uint32_t v) {
+#if defined(_MSC_VER)
+  unsigned long i;
+  _BitScanForward(&i, v);
+  return (int)i;
+#else
+  return __builtin_ctz(v);
+#endif
+}
+
+// Occluded fill: grows seeds towards higher bits (upwards on the board)
+// through runs of set bits in `through`, in five shift steps.
+inline uint32_t fillUp(uint32_t seeds, uint32_t through) {
+  uint32_t g = seeds, p = through;
+  g |= p & (g << 1);
+  p &= p << 1;
+  g |= p & (g << 2);
+  p &= p << 2;
+  g |= p & (g << 4);
+  p &= p << 4;
+  g |= p & (g << 8);
+  p &= p << 8;
+  g |= p & (g << 16);
+  return g;
+}
+
+struct BitCols {
+  uint32_t c[MG];
+
+  bool get(int x, int y) const { return (c[x] >> bitRow(y)) & 1u; }
+  void set(int x, int y) { c[x] |= 1u << bitRow(y); }
+  void clr(int x, int y) { c[x] &= ~(1u << bitRow(y)); }
+  bool any() const {
+    uint32_t a = 0;
+    for (int x = 0; x < MG; x++)
+      a |= c[x];
+    return a != 0;
+  }
+  bool operator==(const BitCols &o) const {
+    return memcmp(c, o.c, sizeof(c)) == 0;
+  }
+};
+
+// ─── Directions ──────────────────────────────────────────────────────────────
+// 2-bit direction codes, clockwise from up. DIR_NONE marks "no last move".
+enum : uint8_t { DIR_UP, DIR_RIGHT, DIR_DOWN, DIR_LEFT, DIR_NONE };
+
+constexpr V2 DIRS[4] = {{0, -1}, {1, 0}, {0, 1}, {-1, 0}};
+constexpr uint8_t dirFlip(uint8_t d) { return (d + 2) & 3; }
+
+// Returns the code for a unit direction vector, DIR_NONE for anything else.
+inline uint8_t dirCode(V2 d) {
+  for (uint8_t i = 0; i < 4; i++)
+    if (DIRS[i] == d)
+      return i;
+  return DIR_NONE;
+}
+
+// ─── Zobrist Keys ────────────────────────────────────────────────────────────
+// A state's 64-bit key is the XOR of one key per feature: each apple and box,
+// each snake segment with its link (or a tail mark), the head and the last
+// direction. Keys are derived from (feature, x, y) with a splitmix finalizer
+// instead of a table, so cells outside the grid get keys too and the same
+// state has the same key in every process.
+enum : uint8_t { ZK_APPLE, ZK_BOX, ZK_LINK, ZK_TAIL = ZK_LINK + 4, ZK_HEAD, ZK_LAST };
+
+inline uint64_t zobKey(int kind, int x, int y) {
+  uint64_t z = ((uint64_t)kind << 32 | (uint64_t)(uint16_t)x << 16 |
+                (uint16_t)y) + 1;
+  z *= 0x9e3779b97f4a7c15ull;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+// ─── Packed Snake ────────────────────────────────────────────────────────────
+// The body is stored as its head position plus one 2-bit link per segment:
+// link i is the direction from segment i to segment i+1 (towards the tail).
+// A snake can never be longer than the board has cells.
+constexpr int SNAKE_MAX = MG * MG;
+constexpr int LINK_WORDS = SNAKE_MAX * 2 / 64;
+
+// Static part of a level: never changes after load.
+struct BitLevel {
+  int w = 0, h = 0;
+  uint32_t rows = 0; // mask of the bits holding in-grid rows
+  BitCols floor{}, trap{}, portal{};
+
+  bool inside(int x, int y) const { return x >= 0 && x < w && y >= 0 && y < h; }
+};
+
+// Dynamic part of a level: everything a move can change.
+struct BitState {
+  BitCols apple{}, box{};
+  uint64_t links[LINK_WORDS]{};
+  int16_t hx = 0, hy = 0; // head (may lie outside the grid)
+  int16_t tx = 0, ty = 0; // tail
+  uint16_t len = 0;
+  // Cells holding a segment, kept by the kernel like hash below, so checks
+  // against the body are lookups rather than walks along the links.
+  // Segments where body has no bit (see inCols) are only counted in stray.
+  BitCols body{};
+  uint16_t stray = 0;
+  int16_t apples = 0;
+  uint8_t lastDir = DIR_NONE;
+  bool won = false, dead = false;
+  // Zobrist key of the snake, apples, boxes and lastDir (not won/dead).
+  // The kernel keeps it current; code that edits the fields above directly
+  // must go through the mutators below or reset it with simHash().
+  uint64_t hash = 0;
+
+  uint8_t link(int i) const { return (links[i >> 5] >> ((i & 31) * 2)) & 3u; }
+  void setLink(int i, uint8_t d) {
+    uint64_t &w = links[i >> 5];
+    int sh = (i & 31) * 2;
+    w = (w & ~(3ull << sh)) | ((uint64_t)d << sh);
+  }
+
+  void setLastDir(uint8_t d) {
+    hash ^= zobKey(ZK_LAST, lastDir, 0) ^ zobKey(ZK_LAST, d, 0);
+    lastDir = d;
+  }
+  void flipApple(int x, int y) {
+    apple.c[x] ^= 1u << bitRow(y);
+    hash ^= zobKey(ZK_APPLE, x, y);
+  }
+  void flipBox(int x, int y) {
+    box.c[x] ^= 1u << bitRow(y);
+    hash ^= zobKey(ZK_BOX, x, y);
+  }
+  // Replaces a whole box column, paying one key per changed cell
+  void setBoxCol(int x, uint32_t mask) {
+    for (uint32_t d = box.c[x] ^ mask; d; d &= d - 1)
+      hash ^= zobKey(ZK_BOX, x, MG - loBit(d));
+    box.c[x] = mask;
+  }
+};
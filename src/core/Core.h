@@ -20,13 +20,6 @@ struct V2 {
 };
 
 // ─── Game State ──────────────────────────────────────────────────────────────
-struct Snap {
-  std::deque<V2> snake;
-  std::deque<V2> prevSnake;
-  std::vector<T> grid;
-  int apples, moves;
-};
-
 // Pure state, no loading logic (moved to engine)
 struct GameState {
   int w = 0, h = 0;
@@ -39,9 +32,19 @@ struct GameState {
   // Permanent record of which tiles started as traps (never mutated after
   // load). Used to restore T::Trap when a box moves off a trap tile.
   std::vector<bool> trapMask;
+  // The cells of each tile type, so views can visit them without scanning
+  // the grid. Floors, traps (covered or not) and portals are fixed per
+  // level, so a portal listed here may be under something else; apples and
+  // boxes follow the grid, kept current by GameEngine. Unordered.
+  std::vector<V2> floorCells, trapCells, portalCells, appleCells, boxCells;
+  // Changes whenever floors or traps may have changed (every level load), so
+  // views can cache what is drawn from them
+  uint32_t layoutGen = 0;
+  // Changes with every command that changes the state (moves, undo, level
+  // loads), so a view can tell when it first shows the result of an input
+  uint32_t version = 0;
   float winTimer = 0, deadTimer = 0, eatFlash = 0, fallShake = 0,
         moveTimer = 1.0f;
-  std::vector<Snap> hist;
 
   T &at(int x, int y) { return grid[y * w + x]; }
   T at(int x, int y) const { return grid[y * w + x]; }
@@ -51,4 +54,26 @@ struct GameState {
       return T::Void;
     return grid[y * w + x];
   }
+
+  // Rebuilds the position lists from grid and trapMask, in row-major order
+  void indexCells() {
+    for (auto *l : {&floorCells, &trapCells, &portalCells, &appleCells,
+                    &boxCells})
+      l->clear();
+    for (int y = 0; y < h; y++) {
+      for (int x = 0; x < w; x++) {
+        T t = at(x, y);
+        if (t == T::Floor)
+          floorCells.push_back({x, y});
+        if (t == T::Trap || trapMask[y * w + x])
+          trapCells.push_back({x, y});
+        if (t == T::Portal)
+          portalCells.push_back({x, y});
+        if (t == T::Apple)
+          appleCells.push_back({x, y});
+        if (t == T::Box)
+          boxCells.push_back({x, y});
+      }
+    }
+  }
 };
@@ -0,0 +1,39 @@
+#pragma once
+#include <atomic>
+
+// ─── Triple Buffer ───────────────────────────────────────────────────────────
+// Hands the latest value from one writer thread to one reader thread without
+// locks or waiting. The writer fills back() and publish()es it; the reader
+// calls update() to take the newest published value, then reads front().
+// Each side owns one slot and the third is swapped through an atomic index,
+// so neither side ever touches a slot the other is using. Values the reader
+// does not pick up in time are overwritten; only the newest one matters.
+//
+// After publish(), back() is a slot holding an older value, so the writer
+// must rewrite it fully rather than patch it.
+template <class T> class TripleBuffer {
+public:
+  // Writer side
+  T &back() { return m_buf[m_back]; }
+  void publish() {
+    m_back = m_mid.exchange(m_back | FRESH, std::memory_order_acq_rel) & SLOT;
+  }
+
+  // Reader side. Returns true if a newer value was swapped into front().
+  bool update() {
+    if (!(m_mid.load(std::memory_order_relaxed) & FRESH))
+      return false;
+    m_front = m_mid.exchange(m_front, std::memory_order_acq_rel) & SLOT;
+    return true;
+  }
+  const T &front() const { return m_buf[m_front]; }
+
+private:
+  static constexpr unsigned SLOT = 3, FRESH = 4; // m_mid: slot | FRESH
+
+  T m_buf[3];
+  // On separate cache lines so the two sides do not contend
+  alignas(64) unsigned m_back = 0; // writer only
+  alignas(64) std::atomic<unsigned> m_mid{1};
+  alignas(64) unsigned m_front = 2; // reader only
+};
@@ -1,19 +1,75 @@
 #include "Game.h"
 #include "Levels.h"
+#include "Sim.h"
+#include <utility>
 
-GameEngine::GameEngine() : m_levelIdx(0) {
-  for (int i = 0; i < 64; i++)
-    m_bestStars[i] = 0;
-}
+GameEngine::GameEngine() : m_levelIdx(0) {}
 
 void GameEngine::loadLevel(int idx) {
   if (idx < 0 || idx >= getNumLevels())
     return;
+  GameState next;
+  if (!loadLevelData(idx, next) || next.w == 0)
+    return; // unreadable level pack record: stay on the current level
   m_levelIdx = idx;
-  m_state = GameState();
-  loadLevelData(idx, m_state);
+  next.layoutGen = m_state.layoutGen + 1;
+  next.version = m_state.version + 1;
+  m_state = std::move(next);
+  if ((int)m_bestStars.size() < getNumLevels())
+    m_bestStars.resize(getNumLevels(), 0);
   m_state.prevSnake = m_state.snake;
   m_state.moveTimer = 1.0f;
+  simLoad(m_state, m_lv, m_bits);
+  m_log.clear();
+
+  m_state.indexCells();
+  int n = m_state.w * m_state.h;
+  m_appleAt.assign(n, -1);
+  m_boxAt.assign(n, -1);
+  for (size_t i = 0; i < m_state.appleCells.size(); i++) {
+    V2 p = m_state.appleCells[i];
+    m_appleAt[p.y * m_state.w + p.x] = (int16_t)i;
+  }
+  for (size_t i = 0; i < m_state.boxCells.size(); i++) {
+    V2 p = m_state.boxCells[i];
+    m_boxAt[p.y * m_state.w + p.x] = (int16_t)i;
+  }
+}
+
+// Adds or removes p in list; at holds each cell's index in list. Removal
+// moves the last entry into the hole.
+static void setCell(std::vector<V2> &list, std::vector<int16_t> &at, int w,
+                    V2 p, bool on) {
+  int16_t &i = at[p.y * w + p.x];
+  if (on == (i >= 0))
+    return;
+  if (on) {
+    i = (int16_t)list.size();
+    list.push_back(p);
+    return;
+  }
+  V2 last = list.back();
+  list[i] = last;
+  at[last.y * w + last.x] = i;
+  list.pop_back();
+  i = -1;
+}
+
+void GameEngine::syncCells(const BitCols &apple0, const BitCols &box0) {
+  GameState &gs = m_state;
+  for (int x = 0; x < gs.w; x++) {
+    uint32_t da = apple0.c[x] ^ m_bits.apple.c[x];
+    uint32_t db = box0.c[x] ^ m_bits.box.c[x];
+    for (uint32_t d = da | db; d; d &= d - 1) {
+      int bit = loBit(d), y = MG - bit;
+      if (y < 0 || y >= gs.h)
+        continue; // off the grid: above the top or fallen out
+      T t = simTile(m_lv, m_bits, x, y);
+      gs.at(x, y) = t;
+      setCell(gs.appleCells, m_appleAt, gs.w, {x, y}, t == T::Apple);
+      setCell(gs.boxCells, m_boxAt, gs.w, {x, y}, t == T::Box);
+    }
+  }
 }
 
 void GameEngine::nextLevel() {
@@ -24,26 +80,29 @@ void GameEngine::prevLevel() { loadLevel(std::max(m_levelIdx - 1, 0)); }
 
 void GameEngine::restartLevel() { loadLevel(m_levelIdx); }
 
-void GameEngine::saveState() {
-  m_state.hist.push_back({m_state.snake, m_state.prevSnake, m_state.grid,
-                          m_state.apples, m_state.moves});
-}
-
 void GameEngine::undo() {
-  if (m_state.hist.empty())
+  BitCols applesBefore = m_bits.apple, boxesBefore = m_bits.box;
+  const MoveRec *rec = m_log.undo(m_bits);
+  if (!rec)
     return;
-  auto &s = m_state.hist.back();
-  m_state.snake = s.snake;
-  m_state.prevSnake = s.prevSnake;
-  m_state.grid = s.grid;
-  m_state.apples = s.apples;
-  m_state.moves = s.moves;
+  // Undo keeps its old behaviour of forgetting the last direction
+  m_bits.setLastDir(DIR_NONE);
+
+  for (auto &seg : m_state.snake)
+    seg.y -= rec->snakeFall;
+  m_state.snake.pop_front();
+  if (!rec->ate)
+    m_state.snake.push_back({m_bits.tx, m_bits.ty});
+  m_state.prevSnake = m_state.snake;
+  syncCells(applesBefore, boxesBefore);
+  m_state.apples = m_bits.apples;
+  m_state.moves--;
   m_state.eatFlash = 0;
   m_state.moveTimer = 1.0f;
   m_state.won = false;
   m_state.dead = false;
   m_state.lastDir = {0, 0};
-  m_state.hist.pop_back();
+  m_state.version++;
 }
 
 void GameEngine::tick(float dt) {
@@ -57,238 +116,75 @@ void GameEngine::tick(float dt) {
     m_state.deadTimer += dt;
 }
 
+bool GameEngine::settled() const {
+  const GameState &s = m_state;
+  return s.moveTimer >= 1.0f && s.eatFlash <= 0 && s.fallShake <= 0 &&
+         !(s.won && s.winTimer < 1.0f) && !(s.dead && s.deadTimer < 1.0f);
+}
+
 int GameEngine::getBestStars(int levelIdx) const {
-  if (levelIdx < 0 || levelIdx >= 64)
+  if (levelIdx < 0 || levelIdx >= (int)m_bestStars.size())
     return 0;
   return m_bestStars[levelIdx];
 }
 
-// Returns true if any snake segment occupies a Trap tile
-static bool touchingTrap(const GameState &s) {
-  for (const auto &seg : s.snake) {
-    if (s.safeAt(seg.x, seg.y) == T::Trap)
-      return true;
-  }
-  return false;
-}
-
-// Restore a tile after a box moves away: Trap if it was originally a trap, else
-// Void
-static void restoreTile(GameState &s, int x, int y) {
-  if (x >= 0 && x < s.w && y >= 0 && y < s.h) {
-    s.at(x, y) = s.trapMask[y * s.w + x] ? T::Trap : T::Void;
-  }
-}
-
-void GameEngine::applyGravity() {
-  // We use a hard limit so no infinite loops on bugs
-  static constexpr int MAX_FALL = 256;
-
-  for (int step = 0; step < MAX_FALL && !m_state.won && !m_state.dead; ++step) {
-    bool changed = true;
-    std::vector<bool> boxStable(m_state.w * m_state.h, false);
-    bool snakeStable = false;
-
-    // Iteratively discover stability
-    while (changed) {
-      changed = false;
-
-      // Check snake stability
-      if (!snakeStable) {
-        for (auto &seg : m_state.snake) {
-          T below = m_state.safeAt(seg.x, seg.y + 1);
-          // Trap is intentionally NOT solid for snake so it falls into them!
-          if (below == T::Floor || below == T::Apple || below == T::Portal ||
-              (below == T::Box && boxStable[(seg.y + 1) * m_state.w + seg.x])) {
-            snakeStable = true;
-            changed = true;
-            break;
-          }
-        }
-      }
-
-      // Check box stability
-      for (int y = 0; y < m_state.h; ++y) {
-        for (int x = 0; x < m_state.w; ++x) {
-          if (m_state.at(x, y) == T::Box && !boxStable[y * m_state.w + x]) {
-            T below = m_state.safeAt(x, y + 1);
-            bool onStable = false;
-
-            // Traps ARE solid for boxes (allows bridging gaps)
-            if (below == T::Floor || below == T::Apple || below == T::Portal ||
-                below == T::Trap) {
-              onStable = true;
-            } else if (below == T::Box && boxStable[(y + 1) * m_state.w + x]) {
-              onStable = true;
-            }
-
-            // Check if it's resting on a stable snake
-            if (!onStable && snakeStable) {
-              for (auto &seg : m_state.snake) {
-                if (seg.x == x && seg.y == y + 1) {
-                  onStable = true;
-                  break;
-                }
-              }
-            }
-
-            if (onStable) {
-              boxStable[y * m_state.w + x] = true;
-              changed = true;
-            }
-          }
-        }
-      }
-    }
-
-    bool anyBoxFalling = false;
-    for (int y = 0; y < m_state.h; ++y) {
-      for (int x = 0; x < m_state.w; ++x) {
-        if (m_state.at(x, y) == T::Box && !boxStable[y * m_state.w + x]) {
-          anyBoxFalling = true;
-        }
-      }
-    }
-
-    if (snakeStable && !anyBoxFalling)
-      break; // everything is stable
-
-    // Check if anything falls off the bottom of the map
-    bool fallsOff = false;
-    if (!snakeStable) {
-      for (auto &seg : m_state.snake) {
-        if (seg.y + 1 >= m_state.h) {
-          fallsOff = true;
-          break;
-        }
-      }
-    }
-
-    if (fallsOff) {
-      m_state.dead = true;
-      return;
-    }
-
-    // Apply fall
-    // Boxes fall (bottom-up to avoid overwriting)
-    if (anyBoxFalling) {
-      for (int y = m_state.h - 1; y >= 0; --y) {
-        for (int x = 0; x < m_state.w; ++x) {
-          if (m_state.at(x, y) == T::Box && !boxStable[y * m_state.w + x]) {
-            // Restore tile the box is leaving
-            restoreTile(m_state, x, y);
-            if (y + 1 < m_state.h) {
-              m_state.at(x, y + 1) = T::Box;
-            }
-            m_state.fallShake = 1.0f;
-          }
-        }
-      }
-    }
-
-    // Snake falls
-    if (!snakeStable) {
-      m_state.prevSnake = m_state.snake;
-      m_state.moveTimer = 0.0f;
-      for (auto &seg : m_state.snake)
-        seg.y++;
-      m_state.fallShake = 1.0f;
-    }
-
-    // Trap check ONLY for snake
-    if (touchingTrap(m_state)) {
-      m_state.dead = true;
-      return;
-    }
+void GameEngine::applyGravity(MoveRec &rec) {
+  simGravity(m_lv, m_bits, &rec);
+  m_state.dead = m_bits.dead;
+
+  if (rec.boxFell || rec.snakeFall > 0)
+    m_state.fallShake = 1.0f;
+  if (rec.snakeFall > 0) {
+    // Animate the last row of the drop, as if it were a single fall step
+    for (auto &seg : m_state.snake)
+      seg.y += rec.snakeFall;
+    m_state.prevSnake = m_state.snake;
+    for (auto &seg : m_state.prevSnake)
+      seg.y--;
+    m_state.moveTimer = 0.0f;
   }
 }
 
 bool GameEngine::doMove(V2 dir) {
   if (m_state.won || m_state.dead || m_state.snake.empty())
     return false;
-  // Input throttling: ignore new moves until previous animation finishes
-  if (m_state.moveTimer < 0.85f)
-    return false;
-
-  // Block reversing direction when snake has ≥2 segments
-  if (m_state.snake.size() > 1) {
-    V2 ld = m_state.lastDir;
-    if (dir.x == -ld.x && dir.y == -ld.y && (ld.x != 0 || ld.y != 0))
-      return false;
-  }
-
-  V2 head = m_state.snake.front();
-  V2 nh = {head.x + dir.x, head.y + dir.y};
-  // Infinite map: any position is valid — no bounds check on nh.
-  // Only the tile at the destination matters.
-
-  T t = m_state.safeAt(nh.x, nh.y);
+  // Moves are never throttled: the state advances at once, and a move made
+  // while the last one is still animating restarts the animation from the
+  // last move's end cells
 
-  // Can't move into a solid floor block
-  if (t == T::Floor)
+  MoveRec rec;
+  BitCols applesBefore = m_bits.apple, boxesBefore = m_bits.box;
+  if (!simMove(m_lv, m_bits, dir, &rec))
     return false;
 
-  if (t == T::Box) {
-    // Push box: destination must be inside the defined map and Void or Trap
-    V2 bh = {nh.x + dir.x, nh.y + dir.y};
-    T tb = m_state.safeAt(bh.x, bh.y);
-    // Allow pushing box onto Trap tiles (box covers the trap)
-    if (tb != T::Void && tb != T::Trap)
-      return false;
-    if (bh.x < 0 || bh.x >= m_state.w || bh.y < 0 || bh.y >= m_state.h)
-      return false;
-
-    saveState();
-    // Restore the tile the box is leaving (Trap if it was originally a trap)
-    restoreTile(m_state, nh.x, nh.y);
-    m_state.at(bh.x, bh.y) = T::Box;
-  } else {
-    // Self-collision (exclude tail, which will move away)
-    for (int i = 0; i < (int)m_state.snake.size() - 1; i++) {
-      if (m_state.snake[i] == nh)
-        return false;
-    }
-    saveState();
-  }
-
   // Commit move
   m_state.prevSnake = m_state.snake;
   m_state.moveTimer = 0.0f;
   m_state.lastDir = dir;
-  m_state.snake.push_front(nh);
+  m_state.snake.push_front({m_bits.hx, m_bits.hy});
   m_state.moves++;
+  m_state.apples = m_bits.apples;
 
-  T cur = m_state.safeAt(nh.x, nh.y);
-
-  if (cur == T::Apple) {
-    // Growth: head moves to apple, old head becomes mid, tail stays → +1 length
-    m_state.at(nh.x, nh.y) = T::Void;
-    m_state.apples--;
+  if (rec.ate) {
     m_state.eatFlash = 1.0f;
     // Do NOT pop_back — tail stays in place
+  } else {
+    m_state.snake.pop_back();
+  }
 
-  } else if (cur == T::Portal) {
+  if (m_bits.won) {
     m_state.won = true;
     m_state.stars = 3;
-    if (m_state.stars > m_bestStars[m_levelIdx])
+    if (m_levelIdx < (int)m_bestStars.size() &&
+        m_state.stars > m_bestStars[m_levelIdx])
       m_bestStars[m_levelIdx] = m_state.stars;
-    m_state.snake.pop_back();
-
-  } else if (cur == T::Trap) {
-    m_state.snake.pop_back();
-    m_state.dead = true;
-    return true;
-
-  } else {
-    m_state.snake.pop_back(); // normal move
-  }
-
-  if (!m_state.won && !m_state.dead && touchingTrap(m_state)) {
-    m_state.dead = true;
-    return true;
   }
+  m_state.dead = m_bits.dead;
 
   if (!m_state.won && !m_state.dead)
-    applyGravity();
+    applyGravity(rec);
+  syncCells(applesBefore, boxesBefore);
+  m_log.push(rec, boxesBefore, m_bits.box);
+  m_state.version++;
   return true;
 }
@@ -1,5 +1,8 @@
 #pragma once
+#include "../core/Bits.h"
 #include "../core/Core.h"
+#include "MoveLog.h"
+#include <vector>
 
 // Encapsulates all game logic and state history.
 // Replaces global functions and state.
@@ -9,8 +12,13 @@ public:
 
     void loadLevel(int idx);
     void tick(float dt);
+    // True when tick() has nothing left to animate: the last move, flash
+    // and shake have run out and a win/death overlay has had a second to
+    // fade in. Only the win/death timers still count up.
+    bool settled() const;
     
-    // Processes a grid movement command.
+    // Processes a grid movement command, even while the previous move is
+    // still animating.
     // dir should be {0,-1}, {0,1}, {-1,0}, or {1,0}.
     // Returns true if the move was valid and executed.
     bool doMove(V2 dir);
@@ -23,15 +31,25 @@ public:
 
     // Read-only access for the renderer
     const GameState& getState() const { return m_state; }
+    // Zobrist key of the current position, updated incrementally per move
+    uint64_t getStateKey() const { return m_bits.hash; }
     
     // Check global best stars
     int getBestStars(int levelIdx) const;
 
 private:
-    void applyGravity();
-    void saveState();
+    void applyGravity(MoveRec& rec);
+    // Rewrites the grid cells, and the apple and box lists, where the
+    // bitboards differ from apple0/box0 (the columns before a change); no
+    // other cell can have changed
+    void syncCells(const BitCols& apple0, const BitCols& box0);
 
-    GameState m_state;
+    GameState m_state; // renderer-facing view, mirrored from the bitboards
+    BitLevel m_lv;     // static level layer for the rule kernel
+    BitState m_bits;   // authoritative simulation state
+    MoveLog m_log;     // reversible history for undo()
     int m_levelIdx;
-    int m_bestStars[64];
+    std::vector<int> m_bestStars; // per level, grown to the level count
+    // Index of each cell in m_state.appleCells / boxCells, -1 if absent
+    std::vector<int16_t> m_appleAt, m_boxAt;
 };
@@ -0,0 +1,246 @@
+#include "LevelPack.h"
+#include "../core/Core.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#if defined(_WIN32)
+// No mmap: the pack is read into memory once instead
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Pack fields are little-endian. These convert between that and the host
+// order, both ways, so a pack reads the same on every host.
+static uint16_t le16(uint16_t v) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  return (uint16_t)(v << 8 | v >> 8);
+#else
+  return v;
+#endif
+}
+static uint32_t le32(uint32_t v) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  return __builtin_bswap32(v);
+#else
+  return v;
+#endif
+}
+static void swapLE(PackHeader &h) {
+  h.version = le32(h.version);
+  h.count = le32(h.count);
+  h.indexOffset = le32(h.indexOffset);
+}
+static void swapLE(PackRecord &r) {
+  r.snakeLen = le16(r.snakeLen);
+  r.apples = le16(r.apples);
+}
+
+LevelPack &LevelPack::operator=(LevelPack &&o) noexcept {
+  if (this != &o) {
+    close();
+    m_data = o.m_data;
+    m_size = o.m_size;
+    m_count = o.m_count;
+    m_mapped = o.m_mapped;
+    o.m_data = nullptr;
+    o.m_size = 0;
+    o.m_count = 0;
+  }
+  return *this;
+}
+
+bool LevelPack::open(const char *path) {
+  close();
+#if defined(_WIN32)
+  FILE *f = fopen(path, "rb");
+  if (!f)
+    return false;
+  fseek(f, 0, SEEK_END);
+  long size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  uint8_t *buf = size > 0 ? new uint8_t[size] : nullptr;
+  bool ok = buf && fread(buf, 1, size, f) == (size_t)size;
+  fclose(f);
+  if (!ok) {
+    delete[] buf;
+    return false;
+  }
+  m_data = buf;
+  m_size = (size_t)size;
+  m_mapped = false;
+#else
+  int fd = ::open(path, O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat st;
+  void *p = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && st.st_size > 0)
+    p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd); // the mapping keeps the file alive
+  if (p == MAP_FAILED)
+    return false;
+  m_data = (const uint8_t *)p;
+  m_size = (size_t)st.st_size;
+  m_mapped = true;
+#endif
+
+  PackHeader hdr;
+  bool ok = m_size >= sizeof(hdr);
+  if (ok) {
+    memcpy(&hdr, m_data, sizeof(hdr));
+    swapLE(hdr);
+    ok = memcmp(hdr.magic, PACK_MAGIC, 4) == 0 &&
+         hdr.version == PACK_VERSION && hdr.indexOffset >= sizeof(hdr) &&
+         hdr.indexOffset <= m_size && hdr.count <= 0x7fffffff &&
+         hdr.count <= (m_size - hdr.indexOffset) / sizeof(uint32_t);
+  }
+  if (!ok) {
+    close();
+    return false;
+  }
+  m_count = (int)hdr.count;
+  return true;
+}
+
+void LevelPack::close() {
+  if (m_data) {
+#if defined(_WIN32)
+    delete[] m_data;
+#else
+    if (m_mapped)
+      munmap((void *)m_data, m_size);
+    else
+      delete[] m_data;
+#endif
+  }
+  m_data = nullptr;
+  m_size = 0;
+  m_count = 0;
+}
+
+// Returns the record header of level idx if the whole record lies inside the
+// file, else nullptr
+const PackRecord *LevelPack::record(int idx, PackRecord &r) const {
+  if (idx < 0 || idx >= m_count)
+    return nullptr;
+  PackHeader hdr;
+  memcpy(&hdr, m_data, sizeof(hdr));
+  swapLE(hdr);
+  uint32_t off;
+  memcpy(&off, m_data + hdr.indexOffset + (size_t)idx * sizeof(off),
+         sizeof(off));
+  off = le32(off);
+  if (off > m_size || m_size - off < sizeof(PackRecord))
+    return nullptr;
+  memcpy(&r, m_data + off, sizeof(r));
+  swapLE(r);
+  size_t len = sizeof(PackRecord) + r.nameLen + 1 + (size_t)r.w * r.h +
+               (size_t)r.snakeLen * 2;
+  if (m_size - off < len || r.w > MG || r.h > MG || r.w == 0 || r.h == 0 ||
+      m_data[off + sizeof(PackRecord) + r.nameLen] != 0)
+    return nullptr;
+  return (const PackRecord *)(m_data + off);
+}
+
+const char *LevelPack::name(int idx) const {
+  PackRecord r;
+  const PackRecord *rec = record(idx, r);
+  return rec ? (const char *)(rec + 1) : "";
+}
+
+bool LevelPack::load(int idx, GameState &state) const {
+  PackRecord r;
+  const PackRecord *rec = record(idx, r);
+  if (!rec)
+    return false;
+  const uint8_t *tiles = (const uint8_t *)(rec + 1) + r.nameLen + 1;
+  const uint8_t *snake = tiles + r.w * r.h;
+  int n = r.w * r.h;
+
+  // The snake must be a non-empty chain of distinct neighbouring cells on
+  // the grid, which is what the rule kernel can represent
+  if (r.snakeLen == 0)
+    return false;
+  bool seen[MG * MG] = {};
+  for (int i = 0; i < r.snakeLen; i++) {
+    int x = snake[i * 2], y = snake[i * 2 + 1];
+    if (x >= r.w || y >= r.h || seen[y * r.w + x])
+      return false;
+    seen[y * r.w + x] = true;
+    if (i > 0 && std::abs(x - snake[i * 2 - 2]) +
+                         std::abs(y - snake[i * 2 - 1]) != 1)
+      return false;
+  }
+  // The apple count comes from the tiles, as for text levels, so a wrong
+  // header count cannot change when the level is won
+  int apples = 0;
+  for (int i = 0; i < n; i++) {
+    if (tiles[i] > (uint8_t)T::Trap)
+      return false;
+    apples += tiles[i] == (uint8_t)T::Apple;
+  }
+
+  state.w = r.w;
+  state.h = r.h;
+  state.grid.resize(n);
+  memcpy(state.grid.data(), tiles, n);
+  state.apples = apples;
+  state.snake.clear();
+  for (int i = 0; i < r.snakeLen; i++)
+    state.snake.push_back({snake[i * 2], snake[i * 2 + 1]});
+  state.trapMask.assign(n, false);
+  for (int i = 0; i < n; i++)
+    if (state.grid[i] == T::Trap)
+      state.trapMask[i] = true;
+  return true;
+}
+
+bool writeLevelPack(const char *path, const std::vector<GameState> &levels,
+                    const std::vector<std::string> &names) {
+  std::vector<uint8_t> out(sizeof(PackHeader) +
+                           levels.size() * sizeof(uint32_t));
+  PackHeader hdr;
+  memcpy(hdr.magic, PACK_MAGIC, 4);
+  hdr.version = PACK_VERSION;
+  hdr.count = (uint32_t)levels.size();
+  hdr.indexOffset = sizeof(PackHeader);
+  PackHeader file = hdr;
+  swapLE(file);
+  memcpy(out.data(), &file, sizeof(file));
+
+  for (size_t i = 0; i < levels.size(); i++) {
+    const GameState &gs = levels[i];
+    std::string name = i < names.size() ? names[i] : std::string();
+    if (gs.w <= 0 || gs.h <= 0 || gs.w > MG || gs.h > MG ||
+        gs.snake.size() > (size_t)MG * MG || name.size() > 255 ||
+        gs.grid.size() != (size_t)gs.w * gs.h || out.size() > 0xffffffffu)
+      return false;
+
+    uint32_t off = le32((uint32_t)out.size());
+    memcpy(out.data() + hdr.indexOffset + i * sizeof(off), &off, sizeof(off));
+    PackRecord r{(uint8_t)gs.w, (uint8_t)gs.h, (uint8_t)name.size(), 0,
+                 (uint16_t)gs.snake.size(), (uint16_t)gs.apples};
+    swapLE(r);
+    const uint8_t *rb = (const uint8_t *)&r;
+    out.insert(out.end(), rb, rb + sizeof(r));
+    out.insert(out.end(), name.begin(), name.end());
+    out.push_back(0);
+    for (T t : gs.grid)
+      out.push_back((uint8_t)t);
+    for (const V2 &p : gs.snake) {
+      if (p.x < 0 || p.x >= gs.w || p.y < 0 || p.y >= gs.h)
+        return false;
+      out.push_back((uint8_t)p.x);
+      out.push_back((uint8_t)p.y);
+    }
+  }
+
+  FILE *f = fopen(path, "wb");
+  if (!f)
+    return false;
+  bool ok = fwrite(out.data(), 1, out.size(), f) == out.size();
+  return fclose(f) == 0 && ok;
+}
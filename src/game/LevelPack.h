@@ -0,0 +1,78 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct GameState;
+
+// ─── Level Packs ─────────────────────────────────────────────────────────────
+// A binary file holding many levels. Packs are memory-mapped, so opening one
+// does not touch its levels, any level is found in O(1) through the offset
+// index, and loading it is a bounds check plus a copy of its tiles.
+//
+// Layout, little-endian:
+//   PackHeader
+//   uint32_t offsets[count]  start of each record, from the start of the file
+//   records, each:
+//     PackRecord
+//     name        nameLen bytes, then a NUL
+//     tiles       w*h bytes of T values, row-major
+//     snake       snakeLen (x, y) byte pairs, head first, each next to the
+//                 one before; at least one, no cell twice
+// The text level characters ('=', 'A', 'P', '#', 'X', H/M/B) are resolved by
+// the packer, so tiles hold T values and the snake is already in order.
+constexpr char PACK_MAGIC[4] = {'S', 'N', 'K', 'P'};
+constexpr uint32_t PACK_VERSION = 1;
+
+struct PackHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t count;
+  uint32_t indexOffset;
+};
+
+struct PackRecord {
+  uint8_t w, h;
+  uint8_t nameLen;
+  uint8_t reserved;
+  uint16_t snakeLen;
+  uint16_t apples; // written for tools; loading counts the apple tiles
+};
+
+class LevelPack {
+public:
+  LevelPack() = default;
+  ~LevelPack() { close(); }
+  LevelPack(const LevelPack &) = delete;
+  LevelPack &operator=(const LevelPack &) = delete;
+  LevelPack(LevelPack &&o) noexcept { *this = std::move(o); }
+  LevelPack &operator=(LevelPack &&o) noexcept;
+
+  // Maps the file and checks its header and index. Records are checked as
+  // they are loaded.
+  bool open(const char *path);
+  void close();
+
+  bool isOpen() const { return m_data != nullptr; }
+  int count() const { return m_count; }
+  // Name of level idx, or "" if idx is out of range or its record is broken
+  const char *name(int idx) const;
+  // Fills w, h, grid, apples, snake and trapMask. Returns false and leaves
+  // state alone if idx is out of range or its record is malformed.
+  bool load(int idx, GameState &state) const;
+
+private:
+  // r receives the record header in host byte order
+  const PackRecord *record(int idx, PackRecord &r) const;
+
+  const uint8_t *m_data = nullptr;
+  size_t m_size = 0;
+  int m_count = 0;
+  bool m_mapped = false; // m_data is an mmap, else it owns a copy
+};
+
+// Writes levels to path as a pack; names[i] labels levels[i]. Levels must fit
+// MG x MG and have a connected snake. Returns false on I/O or size errors.
+bool writeLevelPack(const char *path, const std::vector<GameState> &levels,
+                    const std::vector<std::string> &names);
@@ -1,5 +1,7 @@
 #include "Levels.h"
 #include "../core/Core.h"
+#include "LevelPack.h"
+#include <cstdlib>
 #include <cstring>
 
 struct LvDef {
@@ -9,8 +11,9 @@ struct LvDef {
 };
 
 // Snake format: H=head, M=mid-body segment, B=tail
-// The parser adds them in order: head first, then all M segments (left→right
-// top→bottom), then tail last. Trap tiles use 'X'.
+// The parser walks the body from the head through neighbouring cells: M
+// segments first, then B segments, so the tail is the far end of the chain.
+// Trap tiles use 'X'.
 
 // Trap tiles use 'X'. Box tiles use '#'. Portal tiles use 'P'.
 // Apple tiles use 'A'. Floor tiles use '='. Void tiles use ' '.
@@ -140,25 +143,52 @@ static const LvDef LEVELS[] = {
 };
 static const int NL_COUNT = (int)(sizeof(LEVELS) / sizeof(LEVELS[0]));
 
-int getNumLevels() { return NL_COUNT; }
+// Replaces LEVELS while open
+static LevelPack g_pack;
 
-void loadLevelData(int idx, GameState &state) {
+bool loadLevelPack(const char *path) {
+  LevelPack pack;
+  if (!pack.open(path))
+    return false;
+  g_pack = std::move(pack);
+  return true;
+}
+
+void unloadLevelPack() { g_pack.close(); }
+
+int getNumLevels() { return g_pack.isOpen() ? g_pack.count() : NL_COUNT; }
+
+const char *getLevelName(int idx) {
+  if (g_pack.isOpen())
+    return g_pack.name(idx);
+  if (idx < 0 || idx >= NL_COUNT)
+    return "";
+  return LEVELS[idx].name;
+}
+
+bool loadLevelData(int idx, GameState &state) {
+  if (g_pack.isOpen())
+    return g_pack.load(idx, state);
   if (idx < 0 || idx >= NL_COUNT)
-    return;
+    return false;
   const LvDef &d = LEVELS[idx];
-  state.w = d.w;
-  state.h = d.h;
+  parseLevelRows(d.rows, d.w, d.h, state);
+  return true;
+}
+
+void parseLevelRows(const char *const *rows, int w, int h, GameState &state) {
+  state.w = w;
+  state.h = h;
   state.grid.assign(state.w * state.h, T::Void);
   state.snake.clear();
   state.apples = 0;
 
   V2 head{-1, -1};
-  V2 tail{-1, -1};
   std::vector<V2> mids;  // 'M' mid segments
   std::vector<V2> extra; // 'B' extra body (for long snakes with multi-B)
 
   for (int gy = 0; gy < state.h; gy++) {
-    const char *row = d.rows[gy];
+    const char *row = rows[gy];
     int rl = row ? (int)strlen(row) : 0;
     for (int gx = 0; gx < state.w; gx++) {
       char c = (gx < rl) ? row[gx] : ' ';
@@ -195,15 +225,32 @@ void loadLevelData(int idx, GameState &state) {
     }
   }
 
-  // Build snake: head first, then mids, then extra bodies, tail last
-  // 'B' now acts as extra body segments (behind M), maintaining the
-  // order they appear in the map (left→right, top→bottom).
-  if (head.x >= 0)
+  // Build snake: head first, then follow the body one neighbouring cell at a
+  // time, preferring 'M' over 'B'. The rule kernel stores the body as links
+  // between neighbouring cells, so segments not connected to the chain are
+  // dropped.
+  if (head.x >= 0) {
     state.snake.push_back(head);
-  for (auto &m : mids)
-    state.snake.push_back(m);
-  for (auto &b : extra)
-    state.snake.push_back(b);
+    V2 cur = head;
+    for (;;) {
+      bool found = false;
+      for (auto *segs : {&mids, &extra}) {
+        for (size_t i = 0; i < segs->size() && !found; i++) {
+          V2 p = (*segs)[i];
+          if (std::abs(p.x - cur.x) + std::abs(p.y - cur.y) == 1) {
+            state.snake.push_back(p);
+            segs->erase(segs->begin() + i);
+            cur = p;
+            found = true;
+          }
+        }
+        if (found)
+          break;
+      }
+      if (!found)
+        break;
+    }
+  }
 
   // Build permanent trap mask — used to restore T::Trap when a box moves off
   // one
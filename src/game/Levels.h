@@ -3,6 +3,23 @@
 // Returns the total number of levels available.
 int getNumLevels();
 
+// Returns the display name of the level, or "" if idx is out of range.
+const char* getLevelName(int idx);
+
 // Populates w, h, grid, apples, and snake based on the specified level index.
+// Returns false, leaving state alone, if idx is out of range or its level
+// pack record is broken.
 struct GameState;
-void loadLevelData(int idx, GameState& state);
+bool loadLevelData(int idx, GameState& state);
+
+// Serves levels from a binary level pack (see LevelPack.h) instead of the
+// built-in list. Returns false and keeps the current list if the file can't
+// be opened or is not a pack.
+bool loadLevelPack(const char* path);
+// Goes back to the built-in levels.
+void unloadLevelPack();
+
+// Builds a level from text rows using the level characters: '=' floor,
+// 'A' apple, 'P' portal, '#' box, 'X' trap, H/M/B snake, ' ' or '.' void.
+// Rows shorter than w are padded with void.
+void parseLevelRows(const char* const* rows, int w, int h, GameState& state);
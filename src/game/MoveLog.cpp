@@ -0,0 +1,56 @@
+#include "MoveLog.h"
+
+MoveLog::MoveLog() : m_moves(MAX_MOVES), m_boxes(MAX_BOX_COLS) {}
+
+void MoveLog::clear() {
+  m_first = 0;
+  m_count = 0;
+  m_boxEnd = 0;
+}
+
+void MoveLog::dropOldest() {
+  m_first = (m_first + 1) % MAX_MOVES;
+  m_count--;
+}
+
+void MoveLog::push(const MoveRec &rec, const BitCols &before,
+                   const BitCols &after) {
+  int changed = 0;
+  for (int x = 0; x < MG; x++)
+    if (before.c[x] != after.c[x])
+      changed++;
+
+  // Make room in both rings by forgetting the oldest moves
+  if (m_count == (uint32_t)MAX_MOVES)
+    dropOldest();
+  while (m_count > 0 &&
+         m_boxEnd - m_moves[m_first].boxBegin + changed > (uint32_t)MAX_BOX_COLS)
+    dropOldest();
+
+  Entry &e = m_moves[(m_first + m_count) % MAX_MOVES];
+  e.rec = rec;
+  e.boxBegin = m_boxEnd;
+  e.boxCount = (uint16_t)changed;
+  for (int x = 0; x < MG; x++) {
+    if (before.c[x] != after.c[x]) {
+      m_boxes[m_boxEnd % MAX_BOX_COLS] = {(uint8_t)x, before.c[x]};
+      m_boxEnd++;
+    }
+  }
+  m_count++;
+}
+
+const MoveRec *MoveLog::undo(BitState &s) {
+  if (m_count == 0)
+    return nullptr;
+  const Entry &e = m_moves[(m_first + m_count - 1) % MAX_MOVES];
+  for (uint32_t i = 0; i < e.boxCount; i++) {
+    const BoxCol &b = m_boxes[(e.boxBegin + i) % MAX_BOX_COLS];
+    s.setBoxCol(b.x, b.mask);
+  }
+  simUnmove(s, e.rec);
+  m_boxEnd = e.boxBegin;
+  m_count--;
+  m_last = e.rec;
+  return &m_last;
+}
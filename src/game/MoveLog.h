@@ -0,0 +1,46 @@
+#pragma once
+#include "Sim.h"
+#include <vector>
+
+// Reversible move history. Each move stores its MoveRec plus the previous
+// masks of the box columns it changed, so undo replays the inverse delta
+// instead of restoring a full snapshot. Both rings are allocated once; when
+// either is full the oldest moves are dropped, which bounds memory and keeps
+// recording allocation-free.
+class MoveLog {
+public:
+  static constexpr int MAX_MOVES = 4096;
+  static constexpr int MAX_BOX_COLS = 8192;
+
+  MoveLog();
+
+  void clear();
+  bool empty() const { return m_count == 0; }
+  int size() const { return (int)m_count; }
+
+  // Records a move. before/after are the box bitboards around it.
+  void push(const MoveRec &rec, const BitCols &before, const BitCols &after);
+
+  // Reverts the newest move on s and returns its record, or nullptr if there
+  // is nothing left to undo.
+  const MoveRec *undo(BitState &s);
+
+private:
+  struct Entry {
+    MoveRec rec;
+    uint32_t boxBegin; // running index of its first BoxCol
+    uint16_t boxCount;
+  };
+  struct BoxCol {
+    uint8_t x;
+    uint32_t mask; // column before the move
+  };
+
+  void dropOldest();
+
+  std::vector<Entry> m_moves;
+  std::vector<BoxCol> m_boxes;
+  uint32_t m_first = 0, m_count = 0; // live moves, oldest first
+  uint32_t m_boxEnd = 0;             // running index past the newest BoxCol
+  MoveRec m_last;
+};
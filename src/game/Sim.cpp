@@ -0,0 +1,425 @@
+#include "Sim.h"
+#include <algorithm>
+
+void simLoad(const GameState &gs, BitLevel &lv, BitState &s) {
+  lv = BitLevel();
+  lv.w = gs.w;
+  lv.h = gs.h;
+  lv.rows = (gs.h > 0) ? (((1u << gs.h) - 1) << bitRow(gs.h - 1)) : 0;
+  for (int y = 0; y < gs.h; y++) {
+    for (int x = 0; x < gs.w; x++) {
+      T t = gs.at(x, y);
+      if (t == T::Floor)
+        lv.floor.set(x, y);
+      if (t == T::Portal)
+        lv.portal.set(x, y);
+      if (gs.trapMask[y * gs.w + x])
+        lv.trap.set(x, y);
+    }
+  }
+  simLoadDynamic(gs, s);
+}
+
+// Rebuilds s.body and s.stray from the links
+static void indexBody(BitState &s) {
+  s.body = BitCols{};
+  s.stray = 0;
+  simForEachSegment(s, [&](V2 p) {
+    if (inCols(p.x, p.y))
+      s.body.set(p.x, p.y);
+    else
+      s.stray++;
+  });
+}
+
+// Adds or removes the segment at (x, y) in s.body. Only the two ends come
+// and go, and for a moment they share a cell when the head steps into the
+// cell the tail leaves (or the reverse on undo), so removing an end keeps
+// the bit while both ends are on it.
+static void markEnd(BitState &s, int x, int y, bool on) {
+  if (!inCols(x, y))
+    s.stray = (uint16_t)(on ? s.stray + 1 : s.stray - 1);
+  else if (on)
+    s.body.set(x, y);
+  else if (s.len < 2 || s.hx != s.tx || s.hy != s.ty)
+    s.body.clr(x, y);
+}
+
+void simLoadDynamic(const GameState &gs, BitState &s) {
+  s = BitState();
+  for (int y = 0; y < gs.h; y++) {
+    for (int x = 0; x < gs.w; x++) {
+      T t = gs.at(x, y);
+      if (t == T::Apple)
+        s.apple.set(x, y);
+      if (t == T::Box)
+        s.box.set(x, y);
+    }
+  }
+  s.apples = (int16_t)gs.apples;
+  s.won = gs.won;
+  s.dead = gs.dead;
+  s.lastDir = dirCode(gs.lastDir);
+  s.len = (uint16_t)gs.snake.size();
+  if (s.len == 0)
+    return;
+  s.hx = (int16_t)gs.snake.front().x;
+  s.hy = (int16_t)gs.snake.front().y;
+  s.tx = (int16_t)gs.snake.back().x;
+  s.ty = (int16_t)gs.snake.back().y;
+  for (int i = 0; i + 1 < s.len; i++) {
+    const V2 &a = gs.snake[i], &b = gs.snake[i + 1];
+    s.setLink(i, dirCode({b.x - a.x, b.y - a.y}));
+  }
+  indexBody(s);
+  s.hash = simHash(s);
+}
+
+void simWriteGrid(const BitLevel &lv, const BitState &s, GameState &gs) {
+  for (int y = 0; y < lv.h; y++)
+    for (int x = 0; x < lv.w; x++)
+      gs.at(x, y) = simTile(lv, s, x, y);
+}
+
+T simTile(const BitLevel &lv, const BitState &s, int x, int y) {
+  if (!lv.inside(x, y))
+    return T::Void;
+  if (lv.floor.get(x, y))
+    return T::Floor;
+  if (s.apple.get(x, y))
+    return T::Apple;
+  if (lv.portal.get(x, y))
+    return T::Portal;
+  if (s.box.get(x, y))
+    return T::Box;
+  if (lv.trap.get(x, y))
+    return T::Trap;
+  return T::Void;
+}
+
+// Keys of the snake alone: every segment with its link, the tail mark and
+// the head
+static uint64_t snakeKeys(const BitState &s) {
+  if (s.len == 0)
+    return 0;
+  uint64_t h = zobKey(ZK_HEAD, s.hx, s.hy);
+  int i = 0;
+  simForEachSegment(s, [&](V2 p) {
+    int kind = (i + 1 < s.len) ? ZK_LINK + s.link(i) : ZK_TAIL;
+    h ^= zobKey(kind, p.x, p.y);
+    i++;
+  });
+  return h;
+}
+
+uint64_t simHash(const BitState &s) {
+  uint64_t h = snakeKeys(s) ^ zobKey(ZK_LAST, s.lastDir, 0);
+  for (int x = 0; x < MG; x++) {
+    for (uint32_t b = s.apple.c[x]; b; b &= b - 1)
+      h ^= zobKey(ZK_APPLE, x, MG - loBit(b));
+    for (uint32_t b = s.box.c[x]; b; b &= b - 1)
+      h ^= zobKey(ZK_BOX, x, MG - loBit(b));
+  }
+  return h;
+}
+
+// Moves the whole snake down by dy rows
+static void shiftSnake(BitState &s, int dy) {
+  s.hash ^= snakeKeys(s);
+  s.hy = (int16_t)(s.hy + dy);
+  s.ty = (int16_t)(s.ty + dy);
+  s.hash ^= snakeKeys(s);
+  indexBody(s);
+}
+
+// True if p is a body segment the head cannot enter (the tail moves away)
+static bool hitsBody(const BitState &s, V2 p) {
+  if (p.x == s.tx && p.y == s.ty)
+    return false;
+  if (inCols(p.x, p.y))
+    return s.body.get(p.x, p.y);
+  if (!s.stray)
+    return false;
+  V2 q{s.hx, s.hy}; // p is where body has no bit: walk the links
+  for (int i = 0; i < s.len - 1; i++) {
+    if (q == p)
+      return true;
+    q = q + DIRS[s.link(i)];
+  }
+  return false;
+}
+
+// Returns true if any snake segment occupies an uncovered Trap tile
+static bool touchingTrap(const BitLevel &lv, const BitState &s) {
+  for (int x = 0; x < lv.w; x++)
+    if (s.body.c[x] & lv.trap.c[x] & ~s.box.c[x])
+      return true;
+  return false;
+}
+
+// New head at p; link is the direction from p back to the old head
+static void pushHead(BitState &s, V2 p, uint8_t link) {
+  int words = (s.len + 31) / 32; // links 0..len-1 after the shift
+  for (int i = words - 1; i > 0; i--)
+    s.links[i] = (s.links[i] << 2) | (s.links[i - 1] >> 62);
+  s.links[0] <<= 2;
+  s.setLink(0, link);
+  markEnd(s, p.x, p.y, true);
+  s.hash ^= zobKey(ZK_HEAD, s.hx, s.hy) ^ zobKey(ZK_HEAD, p.x, p.y) ^
+            zobKey(ZK_LINK + link, p.x, p.y);
+  s.hx = (int16_t)p.x;
+  s.hy = (int16_t)p.y;
+  s.len++;
+}
+
+// Drops the head, making segment 1 the new head
+static void popHead(BitState &s) {
+  markEnd(s, s.hx, s.hy, false);
+  V2 d = DIRS[s.link(0)];
+  s.hash ^= zobKey(ZK_HEAD, s.hx, s.hy) ^
+            zobKey(ZK_LINK + s.link(0), s.hx, s.hy) ^
+            zobKey(ZK_HEAD, s.hx + d.x, s.hy + d.y);
+  s.hx = (int16_t)(s.hx + d.x);
+  s.hy = (int16_t)(s.hy + d.y);
+  int words = (s.len + 30) / 32; // links 0..len-2 before the shift
+  for (int i = 0; i < words; i++) {
+    uint64_t carry = (i + 1 < LINK_WORDS) ? s.links[i + 1] << 62 : 0;
+    s.links[i] = (s.links[i] >> 2) | carry;
+  }
+  s.len--;
+}
+
+// Drops the tail and returns the link that led to it
+static uint8_t popTail(BitState &s) {
+  markEnd(s, s.tx, s.ty, false);
+  if (s.len < 2) {
+    s.hash ^= snakeKeys(s);
+    s.len = 0;
+    return 0;
+  }
+  uint8_t link = s.link(s.len - 2);
+  V2 d = DIRS[link];
+  s.hash ^= zobKey(ZK_TAIL, s.tx, s.ty) ^
+            zobKey(ZK_LINK + link, s.tx - d.x, s.ty - d.y) ^
+            zobKey(ZK_TAIL, s.tx - d.x, s.ty - d.y);
+  s.tx = (int16_t)(s.tx - d.x);
+  s.ty = (int16_t)(s.ty - d.y);
+  s.setLink(s.len - 2, 0); // keep unused link bits zero
+  s.len--;
+  return link;
+}
+
+// Appends a tail segment behind the current one
+static void pushTail(BitState &s, uint8_t link) {
+  s.setLink(s.len - 1, link);
+  s.hash ^= zobKey(ZK_TAIL, s.tx, s.ty) ^ zobKey(ZK_LINK + link, s.tx, s.ty) ^
+            zobKey(ZK_TAIL, s.tx + DIRS[link].x, s.ty + DIRS[link].y);
+  s.tx = (int16_t)(s.tx + DIRS[link].x);
+  s.ty = (int16_t)(s.ty + DIRS[link].y);
+  s.len++;
+  markEnd(s, s.tx, s.ty, true);
+}
+
+bool simMove(const BitLevel &lv, BitState &s, V2 dir, MoveRec *rec) {
+  if (s.won || s.dead || s.len == 0)
+    return false;
+  uint8_t d = dirCode(dir);
+  if (d == DIR_NONE)
+    return false;
+
+  // Block reversing direction when snake has ≥2 segments
+  if (s.len > 1 && s.lastDir != DIR_NONE && d == dirFlip(s.lastDir))
+    return false;
+
+  V2 nh = {s.hx + dir.x, s.hy + dir.y};
+  // Infinite map: only the tile at the destination matters.
+  T t = simTile(lv, s, nh.x, nh.y);
+
+  // Can't move into a solid floor block
+  if (t == T::Floor)
+    return false;
+
+  if (t == T::Box) {
+    // Push box: destination must be inside the map and Void or Trap. A box
+    // may have been pushed onto the body; the head still cannot follow it.
+    V2 bh = nh + dir;
+    T tb = simTile(lv, s, bh.x, bh.y);
+    if (tb != T::Void && tb != T::Trap)
+      return false;
+    if (!lv.inside(bh.x, bh.y) || hitsBody(s, nh))
+      return false;
+    s.flipBox(nh.x, nh.y);
+    s.flipBox(bh.x, bh.y);
+  } else if (hitsBody(s, nh)) {
+    return false;
+  }
+
+  // Commit move
+  MoveRec local;
+  if (!rec)
+    rec = &local;
+  *rec = MoveRec();
+  rec->dir = d;
+  rec->lastDir = s.lastDir;
+  pushHead(s, nh, dirFlip(d));
+  s.setLastDir(d);
+
+  T cur = simTile(lv, s, nh.x, nh.y);
+  if (cur == T::Apple) {
+    // Growth: the tail stays in place → +1 length
+    s.flipApple(nh.x, nh.y);
+    s.apples--;
+    rec->ate = true;
+  } else {
+    rec->tailLink = popTail(s);
+    if (cur == T::Portal) {
+      s.won = true;
+    } else if (cur == T::Trap) {
+      s.dead = true;
+      return true;
+    }
+  }
+
+  if (!s.won && touchingTrap(lv, s))
+    s.dead = true;
+  return true;
+}
+
+// Gravity settles in rounds. Each round finds everything that is supported
+// with one upward flood per column, then drops all unsupported objects
+// together by the distance to the next event: an object landing, the snake
+// entering a trap, or the snake reaching the bottom row. Falling objects move
+// in lockstep, so nothing can happen between two events and the result equals
+// dropping one row at a time.
+void simGravity(const BitLevel &lv, BitState &s, MoveRec *rec) {
+  // We use a hard limit so no infinite loops on bugs
+  static constexpr int MAX_ROUNDS = 256;
+  static constexpr int NEVER = 1 << 30;
+  MoveRec local;
+  if (!rec)
+    rec = &local;
+
+  for (int round = 0; round < MAX_ROUNDS && !s.won && !s.dead; ++round) {
+    // Snake cells, plus the rows just above and below the grid: a segment
+    // above can rest on the top row, one below still holds up a box
+    uint32_t near = lv.rows | lv.rows << 1 | lv.rows >> 1;
+    uint32_t body[MG] = {};
+    for (int x = 0; x < lv.w; x++)
+      body[x] = s.body.c[x] & near;
+
+    // Supported boxes: seeded on floors, apples, portals and uncovered traps,
+    // flooded upward through stacked boxes. The snake rests on the same
+    // solids (not on traps) or on a supported box.
+    uint32_t sup[MG] = {}, falling[MG] = {};
+    bool snakeStable = false;
+    for (int x = 0; x < lv.w; x++) {
+      uint32_t solid = lv.floor.c[x] | s.apple.c[x] | lv.portal.c[x];
+      uint32_t base = solid | (lv.trap.c[x] & ~s.box.c[x]);
+      sup[x] = fillUp(s.box.c[x] & (base << 1), s.box.c[x]);
+      if (body[x] & ((solid | sup[x]) << 1))
+        snakeStable = true;
+    }
+
+    // Boxes can also rest on a stable snake
+    bool anyBoxFalling = false;
+    for (int x = 0; x < lv.w; x++) {
+      if (snakeStable) {
+        uint32_t base = lv.floor.c[x] | s.apple.c[x] | lv.portal.c[x] |
+                        (lv.trap.c[x] & ~s.box.c[x]) | body[x];
+        sup[x] = fillUp(s.box.c[x] & ((base | sup[x]) << 1), s.box.c[x]);
+      }
+      falling[x] = s.box.c[x] & ~sup[x];
+      anyBoxFalling |= falling[x] != 0;
+    }
+
+    if (snakeStable && !anyBoxFalling)
+      break; // everything is stable
+
+    // Falling boxes move as stacks; each stack lands when its bottom box
+    // reaches a solid, a trap, a supported box or the stable snake.
+    int drop = NEVER;
+    for (int x = 0; x < lv.w; x++) {
+      if (!falling[x])
+        continue;
+      uint32_t land = lv.floor.c[x] | s.apple.c[x] | lv.portal.c[x] |
+                      lv.trap.c[x] | sup[x] | (snakeStable ? body[x] : 0);
+      for (uint32_t b = falling[x] & ~(falling[x] << 1); b; b &= b - 1) {
+        int r = loBit(b);
+        uint32_t below = land & ((1u << r) - 1);
+        if (below)
+          drop = std::min(drop, r - hiBit(below) - 1);
+      }
+    }
+
+    // Snake events: landing, entering a trap, or hanging off the bottom row
+    int land = NEVER, trap = NEVER, off = NEVER;
+    if (!snakeStable) {
+      int maxY = -NEVER;
+      simForEachSegment(s, [&](V2 p) {
+        maxY = std::max(maxY, p.y);
+        if (p.x < 0 || p.x >= lv.w)
+          return;
+        int r = bitRow(p.y);
+        uint32_t lower = (r >= 32) ? ~0u : (r <= 0 ? 0u : (1u << r) - 1);
+        uint32_t rest = (lv.floor.c[p.x] | s.apple.c[p.x] |
+                         lv.portal.c[p.x] | sup[p.x]) &
+                        lower;
+        if (rest)
+          land = std::min(land, r - hiBit(rest) - 1);
+        // A trap covered by a supported box is reached as a landing first
+        uint32_t spikes = lv.trap.c[p.x] & lower;
+        if (spikes)
+          trap = std::min(trap, r - hiBit(spikes));
+      });
+      off = std::max(0, lv.h - 1 - maxY); // a move can leave the grid
+      drop = std::min({drop, land, trap, off});
+    }
+    if (drop == NEVER)
+      drop = MG; // only boxes are left and all of them fall off the map
+
+    // Drop everything unsupported; boxes leaving the bottom row are gone
+    if (anyBoxFalling && drop > 0) {
+      for (int x = 0; x < lv.w; x++)
+        s.setBoxCol(x, sup[x] | ((falling[x] >> drop) & lv.rows));
+      rec->boxFell = true;
+    }
+
+    if (!snakeStable) {
+      shiftSnake(s, drop);
+      rec->snakeFall += drop;
+      // Trap check ONLY for snake. Hanging off the bottom is only fatal once
+      // a round starts there unsupported (off == 0, nothing moved); a box
+      // landing in the same round may still catch the snake.
+      if (drop == trap || off == 0) {
+        s.dead = true;
+        return;
+      }
+    }
+  }
+}
+
+bool simStep(const BitLevel &lv, BitState &s, V2 dir, MoveRec *rec) {
+  MoveRec local;
+  if (!rec)
+    rec = &local;
+  if (!simMove(lv, s, dir, rec))
+    return false;
+  if (!s.won && !s.dead)
+    simGravity(lv, s, rec);
+  return true;
+}
+
+void simUnmove(BitState &s, const MoveRec &rec) {
+  s.won = false;
+  s.dead = false;
+  if (rec.snakeFall)
+    shiftSnake(s, -rec.snakeFall);
+  if (rec.ate) {
+    s.flipApple(s.hx, s.hy);
+    s.apples++;
+  } else {
+    pushTail(s, rec.tailLink);
+  }
+  popHead(s);
+  s.setLastDir(rec.lastDir);
+}
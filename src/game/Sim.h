@@ -0,0 +1,52 @@
+#pragma once
+#include "../core/Bits.h"
+
+// Rule kernel operating on the bitboard state (see core/Bits.h).
+// GameEngine drives these for interactive play; solvers and tools call them
+// directly so every caller shares exactly the same move and gravity rules.
+
+// What a move did, for callers that present it (flashes, shakes, animation)
+// and for simUnmove. Box changes are not recorded here; callers that undo keep
+// the box columns themselves (see MoveLog).
+struct MoveRec {
+  bool ate = false;     // head landed on an apple
+  bool boxFell = false; // at least one box dropped during gravity
+  int snakeFall = 0;    // rows the snake dropped during gravity
+  uint8_t dir = DIR_NONE;     // direction moved
+  uint8_t lastDir = DIR_NONE; // s.lastDir before the move
+  uint8_t tailLink = 0;       // link dropped with the tail when !ate
+};
+
+// Builds the static level and the dynamic state from a loaded GameState.
+void simLoad(const GameState &gs, BitLevel &lv, BitState &s);
+// Rebuilds only the dynamic state (snake, apples, boxes) from a GameState.
+void simLoadDynamic(const GameState &gs, BitState &s);
+// Writes the tile grid of gs to match the bitboards.
+void simWriteGrid(const BitLevel &lv, const BitState &s, GameState &gs);
+
+// Recomputes the Zobrist key of s from scratch (s.hash is kept incrementally)
+uint64_t simHash(const BitState &s);
+
+// Tile shown at (x,y): a box hides the trap under it. T::Void off the grid.
+T simTile(const BitLevel &lv, const BitState &s, int x, int y);
+
+// Moves the head one cell in dir (a unit vector) without settling gravity.
+// Returns false and leaves s untouched if the move is not allowed.
+bool simMove(const BitLevel &lv, BitState &s, V2 dir, MoveRec *rec = nullptr);
+// Lets the snake and boxes fall until everything rests or the snake dies.
+void simGravity(const BitLevel &lv, BitState &s, MoveRec *rec = nullptr);
+// One full turn: simMove followed by simGravity if the game goes on.
+bool simStep(const BitLevel &lv, BitState &s, V2 dir, MoveRec *rec = nullptr);
+// Reverts the snake, apple and flags of a move recorded by simStep. Boxes
+// must be restored by the caller.
+void simUnmove(BitState &s, const MoveRec &rec);
+
+// Calls f(V2) for every segment, head first.
+template <class F> void simForEachSegment(const BitState &s, F f) {
+  V2 p{s.hx, s.hy};
+  for (int i = 0; i < s.len; i++) {
+    f(p);
+    if (i + 1 < s.len)
+      p = p + DIRS[s.link(i)];
+  }
+}
@@ -0,0 +1,170 @@
+#include "SimLoop.h"
+#include <algorithm>
+#include <chrono>
+
+SimLoop::SimLoop(int level) {
+  m_engine.loadLevel(level);
+  publish();
+  m_frames.update();
+}
+
+SimLoop::~SimLoop() { stop(); }
+
+void SimLoop::setIdleRate(int hz) {
+  m_idleTicks = hz > 0 ? std::max(1, HZ / hz) : 0;
+}
+
+void SimLoop::start() {
+  if (m_thread.joinable())
+    return;
+  m_stop = false;
+  m_thread = std::thread(&SimLoop::run, this);
+}
+
+void SimLoop::stop() {
+  if (!m_thread.joinable())
+    return;
+  {
+    std::lock_guard<std::mutex> lk(m_mu);
+    m_stop = true;
+  }
+  m_cv.notify_one();
+  m_thread.join();
+}
+
+void SimLoop::push(Cmd c) {
+  {
+    std::lock_guard<std::mutex> lk(m_mu);
+    m_inputs.push_back({c, Clock::now()});
+  }
+  m_cv.notify_one();
+}
+
+void SimLoop::takeStamps(uint32_t version,
+                         std::vector<Clock::time_point> &out) {
+  std::lock_guard<std::mutex> lk(m_mu);
+  size_t n = 0;
+  // Versions only grow, so the stamps taken are a prefix
+  while (n < m_stamps.size() && (int32_t)(m_stamps[n].version - version) <= 0)
+    out.push_back(m_stamps[n++].t);
+  m_stamps.erase(m_stamps.begin(), m_stamps.begin() + n);
+}
+
+void SimLoop::publish() {
+  SimFrame &f = m_frames.back();
+  f.state = m_engine.getState();
+  f.level = m_engine.getCurrentLevel();
+  f.time = m_time;
+  m_frames.publish();
+}
+
+// Sleeps until the next tick or the next command. Commands are applied on
+// arrival; ticks always advance the engine by DT, catching up on any missed
+// ones so animation speed does not depend on how the thread is scheduled.
+void SimLoop::run() {
+  const auto step = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(DT));
+  // After a stall longer than this (suspend, debugger) skip ahead instead
+  // of replaying every missed tick. A frozen sleep is not a stall: those
+  // ticks are replayed like any other idle sleep.
+  const auto stall = std::chrono::milliseconds(250) + m_idleTicks * step;
+  Clock::time_point next = Clock::now() + step;
+  std::vector<Input> inputs;
+  std::vector<Stamp> stamps;
+  std::unique_lock<std::mutex> lk(m_mu);
+  auto woken = [&] { return m_stop || !m_inputs.empty(); };
+  while (!m_stop) {
+    // With no idle rate a settled engine sleeps until input or stop()
+    bool frozen = m_idleTicks == 0 && m_engine.settled();
+    if (frozen)
+      m_cv.wait(lk, woken);
+    else if (m_engine.settled())
+      m_cv.wait_until(lk, next + (m_idleTicks - 1) * step, woken);
+    else
+      m_cv.wait_until(lk, next, woken);
+    if (m_stop)
+      break;
+    inputs.swap(m_inputs);
+    lk.unlock();
+
+    bool changed = !inputs.empty();
+    auto advance = [&](Clock::time_point t) {
+      for (; next <= t; next += step) {
+        m_engine.tick(DT);
+        m_time += DT;
+        changed = true;
+      }
+    };
+    Clock::time_point now = Clock::now();
+    if (now - next > stall && !frozen)
+      next = now;
+    for (const Input &in : inputs) {
+      advance(in.t);
+      uint32_t v = m_engine.getState().version;
+      apply(in.cmd);
+      if (m_engine.getState().version != v)
+        stamps.push_back({m_engine.getState().version, in.t});
+    }
+    inputs.clear();
+    advance(now);
+    if (changed)
+      publish();
+
+    lk.lock();
+    bool byInput = !stamps.empty();
+    m_stamps.insert(m_stamps.end(), stamps.begin(), stamps.end());
+    stamps.clear();
+    if (m_stamps.size() > MAX_STAMPS)
+      m_stamps.erase(m_stamps.begin(), m_stamps.end() - MAX_STAMPS);
+    // The stamps are in place before the reader hears of the frame
+    if (byInput && m_onInput) {
+      lk.unlock();
+      m_onInput();
+      lk.lock();
+    }
+  }
+}
+
+void SimLoop::apply(Cmd c) {
+  const GameState &s = m_engine.getState();
+  if (s.dead) {
+    if (c == Cmd::Restart || c == Cmd::Confirm)
+      m_engine.restartLevel();
+    return;
+  }
+  if (s.won) {
+    if (c == Cmd::Next || c == Cmd::Confirm)
+      m_engine.nextLevel();
+    else if (c == Cmd::Restart)
+      m_engine.restartLevel();
+    return;
+  }
+  switch (c) {
+  case Cmd::Up:
+    m_engine.doMove({0, -1});
+    break;
+  case Cmd::Down:
+    m_engine.doMove({0, 1});
+    break;
+  case Cmd::Left:
+    m_engine.doMove({-1, 0});
+    break;
+  case Cmd::Right:
+    m_engine.doMove({1, 0});
+    break;
+  case Cmd::Undo:
+    m_engine.undo();
+    break;
+  case Cmd::Restart:
+    m_engine.restartLevel();
+    break;
+  case Cmd::Next:
+    m_engine.nextLevel();
+    break;
+  case Cmd::Prev:
+    m_engine.prevLevel();
+    break;
+  case Cmd::Confirm:
+    break;
+  }
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include "../core/TripleBuffer.h"
+#include "Game.h"
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// What the renderer draws: a copy of the engine state at one instant
+struct SimFrame {
+  GameState state;
+  int level = 0;
+  float time = 0; // simulated seconds since start
+};
+
+// ─── Simulation Loop ─────────────────────────────────────────────────────────
+// Runs the GameEngine on its own thread at a fixed timestep, independent of
+// the display rate, and publishes a SimFrame after every change through a
+// triple buffer. Input reaches the engine only as commands queued by
+// push(), which the loop applies as soon as they arrive rather than at the
+// next tick, so neither a slow frame nor vsync holds input back. Commands
+// are stamped on arrival and applied in order, each after the ticks that
+// came before it, so the outcome depends on when keys were pressed and not
+// on thread timing. The engine is touched by the loop thread alone once
+// start() has been called.
+//
+// While the engine is settled the loop wakes only at the idle rate (or on
+// input) and runs the ticks it slept through in one go, so a resting game
+// costs almost nothing yet ends up in the same state. With an idle rate of
+// 0 it wakes on input alone.
+class SimLoop {
+public:
+  // Player commands; what they do depends on the state (see apply())
+  enum class Cmd : uint8_t {
+    Up,
+    Down,
+    Left,
+    Right,
+    Undo,
+    Restart,
+    Next,
+    Prev,
+    Confirm // Enter/Space: restart when dead, next level when won
+  };
+
+  static constexpr int HZ = 120;
+  static constexpr float DT = 1.0f / HZ;
+
+  using Clock = std::chrono::steady_clock;
+
+  // Loads level `level` and publishes it, so frame() is valid right away
+  explicit SimLoop(int level = 0);
+  ~SimLoop();
+  SimLoop(const SimLoop &) = delete;
+  SimLoop &operator=(const SimLoop &) = delete;
+
+  // Both before start()
+  // Publish rate while the engine is settled, HZ at most (the default).
+  // 0 publishes nothing until input arrives; the ticks slept through are
+  // still run then.
+  void setIdleRate(int hz);
+  // Called on the loop thread after publishing a frame changed by input
+  void setOnInput(std::function<void()> fn) { m_onInput = std::move(fn); }
+
+  void start();
+  void stop();
+
+  // Any thread. Queues c, stamped with the current time.
+  void push(Cmd c);
+
+  // Reader side, one thread: update() takes the newest published frame and
+  // returns true if there was one; frame() is the one taken last
+  bool update() { return m_frames.update(); }
+  const SimFrame &frame() const { return m_frames.front(); }
+  // Moves into out the arrival times of the inputs whose results are in
+  // GameState::version `version` or earlier, for latency tracing. Only the
+  // newest MAX_STAMPS are kept until taken.
+  void takeStamps(uint32_t version, std::vector<Clock::time_point> &out);
+
+private:
+  static constexpr size_t MAX_STAMPS = 256;
+
+  struct Input {
+    Cmd cmd;
+    Clock::time_point t; // when push() queued it
+  };
+  // An input that changed the state, and the version it changed it to
+  struct Stamp {
+    uint32_t version;
+    Clock::time_point t;
+  };
+
+  void run();
+  void apply(Cmd c);
+  void publish();
+
+  GameEngine m_engine;
+  float m_time = 0;
+  int m_idleTicks = 1; // ticks slept through at once while settled, 0: all
+  std::function<void()> m_onInput;
+  TripleBuffer<SimFrame> m_frames;
+
+  std::thread m_thread;
+  std::mutex m_mu; // guards m_inputs, m_stamps and m_stop
+  std::condition_variable m_cv;
+  std::vector<Input> m_inputs; // in arrival order
+  std::vector<Stamp> m_stamps; // published, not yet taken
+  bool m_stop = false;
+};
@@ -1,21 +1,26 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
 #include "core/Core.h"
 #include "game/Levels.h"
-#include "game/Game.h"
+#include "game/SimLoop.h"
 #include "render/Render.h"
 
-// The main Application state
+// The main Application state. The simulation runs on its own thread; this
+// thread only handles events and draws the frames it publishes.
 struct App {
-    GameEngine engine;
-    Renderer   renderer;
-    float      time = 0.0f;
+    SimLoop  sim;
+    Renderer renderer;
+    bool     redraw = true; // draw the next frame even if nothing changed
 };
 
 // We need a global pointer just for the GLFW callback
 static App* g_app = nullptr;
 
+// Keys become SimLoop commands; the simulation decides what they mean in
+// the state it is in
 static void keyCB(GLFWwindow* win, int key, int, int act, int) {
     if (!g_app) return;
     if (act != GLFW_PRESS) return;
@@ -25,41 +30,55 @@ static void keyCB(GLFWwindow* win, int key, int, int act, int) {
         return; 
     }
 
-    const GameState& state = g_app->engine.getState();
-
-    if (state.dead) {
-        if (key == GLFW_KEY_R || key == GLFW_KEY_ENTER || key == GLFW_KEY_SPACE) {
-            g_app->engine.restartLevel();
-        }
+    // Frame profiler: F3 shows it, F4 saves its history
+    if (key == GLFW_KEY_F3) {
+        g_app->renderer.toggleProfiler();
+        g_app->redraw = true;
         return;
     }
-
-    if (state.won) {
-        if (key == GLFW_KEY_ENTER || key == GLFW_KEY_SPACE || key == GLFW_KEY_N) {
-            g_app->engine.nextLevel();
-        }
-        if (key == GLFW_KEY_R) {
-            g_app->engine.restartLevel();
-        }
+    if (key == GLFW_KEY_F4) {
+        const char* path = "snake_profile.csv";
+        if (g_app->renderer.dumpProfile(path))
+            std::cout << "Profile written to " << path << std::endl;
+        else
+            std::cerr << path << ": write failed\n";
+        return;
+    }
+    // Input latency: F5 shows it and logs every input while shown
+    if (key == GLFW_KEY_F5) {
+        const char* path = "snake_latency.csv";
+        if (!g_app->renderer.toggleLatency(path))
+            std::cerr << path << ": cannot write latency log\n";
+        g_app->redraw = true;
         return;
     }
 
+    using Cmd = SimLoop::Cmd;
+    SimLoop& sim = g_app->sim;
     switch (key) {
-        case GLFW_KEY_UP:    case GLFW_KEY_W: g_app->engine.doMove({0, -1}); break;
-        case GLFW_KEY_DOWN:  case GLFW_KEY_S: g_app->engine.doMove({0, 1}); break;
-        case GLFW_KEY_LEFT:  case GLFW_KEY_A: g_app->engine.doMove({-1, 0}); break;
-        case GLFW_KEY_RIGHT: case GLFW_KEY_D: g_app->engine.doMove({1, 0}); break;
+        case GLFW_KEY_UP:    case GLFW_KEY_W: sim.push(Cmd::Up); break;
+        case GLFW_KEY_DOWN:  case GLFW_KEY_S: sim.push(Cmd::Down); break;
+        case GLFW_KEY_LEFT:  case GLFW_KEY_A: sim.push(Cmd::Left); break;
+        case GLFW_KEY_RIGHT: case GLFW_KEY_D: sim.push(Cmd::Right); break;
         
         case GLFW_KEY_Z:
-        case GLFW_KEY_U: g_app->engine.undo(); break;
+        case GLFW_KEY_U: sim.push(Cmd::Undo); break;
         
-        case GLFW_KEY_R: g_app->engine.restartLevel(); break;
-        case GLFW_KEY_N: g_app->engine.nextLevel(); break;
-        case GLFW_KEY_P: g_app->engine.prevLevel(); break;
+        case GLFW_KEY_R: sim.push(Cmd::Restart); break;
+        case GLFW_KEY_N: sim.push(Cmd::Next); break;
+        case GLFW_KEY_P: sim.push(Cmd::Prev); break;
+
+        case GLFW_KEY_ENTER:
+        case GLFW_KEY_SPACE: sim.push(Cmd::Confirm); break;
     }
 }
 
-int main() {
+int main(int argc, char** argv) {
+    // Optional level pack: snake_puzzle [levels.pack]
+    if (argc > 1 && !loadLevelPack(argv[1])) {
+        std::cerr << argv[1] << ": not a level pack\n";
+        return 1;
+    }
     if (!glfwInit()) { std::cerr << "GLFW init failed\n"; return 1; }
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -91,29 +110,31 @@ int main() {
 
         // Reset button
         if (x >= 12 && x <= 52 && y >= 10 && y <= 50) {
-            g_app->engine.restartLevel();
+            g_app->sim.push(SimLoop::Cmd::Restart);
             return;
         }
 
-        if (g_app->engine.getState().dead) {
+        // Overlay buttons are hit-tested against the frame on screen
+        const GameState& state = g_app->sim.frame().state;
+        if (state.dead) {
             // Death overlay restart button: same position as win overlay next button
             float bw = 180, bh = 46;
             float bx = (fw - bw) * 0.5f;
             float ph = 240.f;
             float by = (fh - ph) * 0.5f + ph - 70.f;
             if (x >= bx && x <= bx + bw && y >= by && y <= by + bh) {
-                g_app->engine.restartLevel();
+                g_app->sim.push(SimLoop::Cmd::Restart);
             }
             return;
         }
 
-        if (g_app->engine.getState().won) {
+        if (state.won) {
             float bw = 180, bh = 46;
             float bx = (fw - bw) * 0.5f;
             float by = (fh - 260) * 0.5f + 190.f; // ppy + ph - 70 = (fh-260)/2 + 260 - 70 = (fh-260)/2 + 190
             
             if (x >= bx && x <= bx + bw && y >= by && y <= by + bh) {
-                g_app->engine.nextLevel();
+                g_app->sim.push(SimLoop::Cmd::Next);
             }
         }
     };
@@ -130,33 +151,74 @@ int main() {
     g_app = &app; // Bind for the keyboard callback
 
     app.renderer.init(1006, 577);
-    app.engine.loadLevel(0); // Start at level 0
-    std::cout << "Level loaded. State config: W=" << app.engine.getState().w << " H=" << app.engine.getState().h << " SnakeLen=" << app.engine.getState().snake.size() << std::endl;
-
-    double prev = glfwGetTime();
+    const GameState& first = app.sim.frame().state; // level 0
+    std::cout << "Level loaded. State config: W=" << first.w << " H=" << first.h << " SnakeLen=" << first.snake.size() << std::endl;
+
+    // Frames are drawn on demand: at the display rate while something
+    // moves, at the idle rate while only the portal and apples loop, and
+    // otherwise only when the state or the window changes. Between frames
+    // the loop sleeps in glfwWaitEvents*. SNAKE_IDLE_FPS sets the idle rate
+    // (default 10, 0 freezes the loops).
+    const char* idleEnv = getenv("SNAKE_IDLE_FPS");
+    int idleFps = std::clamp(idleEnv ? atoi(idleEnv) : 10, 0, SimLoop::HZ);
+    app.sim.setIdleRate(idleFps);
+    // Input applied on the sim thread wakes the loop below
+    app.sim.setOnInput([] { glfwPostEmptyEvent(); });
+    glfwSetWindowRefreshCallback(win, [](GLFWwindow*) {
+        if (g_app) g_app->redraw = true;
+    });
+    app.sim.start();
+
+    std::vector<SimLoop::Clock::time_point> shown; // latency stamps
+    uint32_t drawnVersion = 0;
+    bool moving = false; // the last frame drawn was mid-motion
+    double lastDraw = 0;
+    int fbW = 0, fbH = 0;
     
     while (!glfwWindowShouldClose(win)) {
-        double now = glfwGetTime();
-        float dt = (float)(now - prev);
-        prev = now;
-        app.time += dt;
-
         int w, h;
         glfwGetFramebufferSize(win, &w, &h);
-        app.renderer.resize(w, h);
+        if (w != fbW || h != fbH) {
+            fbW = w;
+            fbH = h;
+            app.redraw = true;
+        }
 
-        app.engine.tick(dt);
-        
-        glfwPollEvents();
-        
-        // Render the current state cleanly
-        int curLevel = app.engine.getCurrentLevel();
-        int totLevel = getNumLevels();
-        app.renderer.renderFrame(app.engine.getState(), curLevel, totLevel, app.time);
+        // Draw the newest state the simulation has published, if needed
+        app.sim.update();
+        const SimFrame& f = app.sim.frame();
+        Renderer::Motion m = app.renderer.motion(f.state);
+        double now = glfwGetTime();
+        bool ambient = m == Renderer::Motion::AMBIENT && idleFps > 0;
+        double idleDue = lastDraw + 1.0 / std::max(idleFps, 1);
+        // After motion, one more frame shows where it came to rest
+        bool draw = app.redraw || moving || m == Renderer::Motion::FULL ||
+                    f.state.version != drawnVersion ||
+                    (ambient && now >= idleDue);
+        if (!draw) {
+            if (ambient)
+                glfwWaitEventsTimeout(idleDue - now);
+            else
+                glfwWaitEvents();
+            continue;
+        }
+        app.redraw = false;
+        moving = m == Renderer::Motion::FULL;
+        drawnVersion = f.state.version;
+        lastDraw = now;
+
+        app.renderer.resize(w, h);
+        app.renderer.renderFrame(f.state, f.level, getNumLevels(), f.time);
         
         glfwSwapBuffers(win);
+        app.sim.takeStamps(f.state.version, shown);
+        app.renderer.presented(shown);
+        shown.clear();
+
+        glfwPollEvents();
     }
 
+    app.sim.stop();
     g_app = nullptr;
     glfwDestroyWindow(win);
     glfwTerminate();
@@ -0,0 +1,103 @@
+#include "Latency.h"
+#include <algorithm>
+
+const char *const LatencyTracer::SERIES_NAMES[NUM_SERIES] = {"PRESENT",
+                                                             "GPU"};
+
+// Frames whose fence is still pending; past this the oldest is given up on
+static constexpr size_t MAX_PENDING = 8;
+
+static float msSince(LatencyTracer::Clock::time_point t,
+                     LatencyTracer::Clock::time_point now) {
+  return std::chrono::duration<float, std::milli>(now - t).count();
+}
+
+LatencyTracer::~LatencyTracer() { setOn(false, nullptr); }
+
+bool LatencyTracer::setOn(bool on, const char *path) {
+  drop();
+  if (m_log)
+    fclose(m_log);
+  m_log = nullptr;
+  m_on = on;
+  if (!on)
+    return true;
+  m_start = Clock::now();
+  for (int s = 0; s < NUM_SERIES; s++) {
+    m_count[s] = m_head[s] = 0;
+    std::fill(m_hist[s], m_hist[s] + BUCKETS, 0);
+  }
+  m_log = fopen(path, "w");
+  if (!m_log)
+    return false;
+  fputs("input_s,present_ms,gpu_ms\n", m_log);
+  return true;
+}
+
+void LatencyTracer::presented(const std::vector<Clock::time_point> &inputs) {
+  if (!m_on || inputs.empty())
+    return;
+  Clock::time_point now = Clock::now();
+  for (Clock::time_point t : inputs)
+    record(PRESENT, msSince(t, now));
+  GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  glFlush(); // so polling the fence without a flush bit still completes
+  m_pending.push_back({fence, now, inputs});
+  if (m_pending.size() > MAX_PENDING) {
+    glDeleteSync(m_pending.front().fence);
+    m_pending.pop_front();
+  }
+}
+
+void LatencyTracer::poll() {
+  while (!m_pending.empty()) {
+    Pending &p = m_pending.front();
+    GLenum r = glClientWaitSync(p.fence, 0, 0);
+    if (r == GL_TIMEOUT_EXPIRED)
+      break;
+    if (r != GL_WAIT_FAILED) {
+      Clock::time_point now = Clock::now();
+      for (Clock::time_point t : p.inputs) {
+        float gpu = msSince(t, now);
+        record(GPU, gpu);
+        if (m_log)
+          fprintf(m_log, "%.4f,%.3f,%.3f\n",
+                  std::chrono::duration<double>(t - m_start).count(),
+                  msSince(t, p.present), gpu);
+      }
+    }
+    glDeleteSync(p.fence);
+    m_pending.pop_front();
+  }
+  if (m_log)
+    fflush(m_log);
+}
+
+void LatencyTracer::drop() {
+  for (Pending &p : m_pending)
+    glDeleteSync(p.fence);
+  m_pending.clear();
+}
+
+void LatencyTracer::record(Series s, float ms) {
+  auto bucket = [](float v) { return std::min(BUCKETS - 1, (int)v); };
+  if (m_count[s] == SAMPLES)
+    m_hist[s][bucket(m_samples[s][m_head[s]])]--;
+  else
+    m_count[s]++;
+  m_samples[s][m_head[s]] = ms;
+  m_head[s] = (m_head[s] + 1) % SAMPLES;
+  m_hist[s][bucket(ms)]++;
+}
+
+LatencyTracer::Stats LatencyTracer::stats(Series s) const {
+  Stats st = {m_count[s], 0, 0, 0};
+  if (st.n == 0)
+    return st;
+  std::vector<float> v(m_samples[s], m_samples[s] + st.n);
+  std::sort(v.begin(), v.end());
+  st.min = v[0];
+  st.p50 = v[st.n / 2];
+  st.p99 = v[std::min(st.n - 1, st.n * 99 / 100)];
+  return st;
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <GL/glew.h>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <vector>
+
+// ─── Input Latency Tracer ────────────────────────────────────────────────────
+// Measures, for every input that changed the game state, the time from the
+// key event to the first frame showing its result. Two points are taken:
+// when glfwSwapBuffers returned for that frame ("present"), and when a fence
+// placed right after the swap was seen signaled, i.e. when the GPU had
+// finished the frame ("gpu"). Fences are only polled once per frame, never
+// waited on, so the gpu figure may be late by up to a frame; scanout after
+// that is not visible to GL at all.
+//
+// The newest SAMPLES latencies of each kind are kept for the overlay's stats
+// and histogram; while on, every input is also logged to a CSV file.
+class LatencyTracer {
+public:
+  using Clock = std::chrono::steady_clock;
+  enum Series { PRESENT, GPU, NUM_SERIES };
+  static const char *const SERIES_NAMES[NUM_SERIES];
+
+  static constexpr int SAMPLES = 1024;
+  // Histogram buckets are 1 ms wide; the last one takes everything slower
+  static constexpr int BUCKETS = 50;
+
+  struct Stats {
+    int n;
+    float min, p50, p99; // ms
+  };
+
+  LatencyTracer() = default;
+  ~LatencyTracer();
+  LatencyTracer(const LatencyTracer &) = delete;
+  LatencyTracer &operator=(const LatencyTracer &) = delete;
+
+  // Turning it on starts a new log at path; off drops pending fences and
+  // closes the log. False if the log cannot be opened (tracing still runs).
+  bool setOn(bool on, const char *path);
+  bool on() const { return m_on; }
+
+  // Right after a swap: inputs first shown by the frame just presented
+  void presented(const std::vector<Clock::time_point> &inputs);
+  // Once per frame: collects the frames the GPU has finished
+  void poll();
+
+  Stats stats(Series s) const;
+  const int *histogram(Series s) const { return m_hist[s]; }
+
+private:
+  struct Pending {
+    GLsync fence;
+    Clock::time_point present;
+    std::vector<Clock::time_point> inputs;
+  };
+
+  void record(Series s, float ms);
+  void drop();
+
+  bool m_on = false;
+  std::deque<Pending> m_pending; // oldest first
+  FILE *m_log = nullptr;
+  Clock::time_point m_start;
+
+  float m_samples[NUM_SERIES][SAMPLES];
+  int m_count[NUM_SERIES] = {}, m_head[NUM_SERIES] = {};
+  int m_hist[NUM_SERIES][BUCKETS] = {};
+};
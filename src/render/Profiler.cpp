@@ -0,0 +1,136 @@
+#include "Profiler.h"
+#include <cctype>
+#include <cstdio>
+
+const char *const Profiler::PASS_NAMES[NUM_PASSES] = {
+    "SKY",     "CITY",   "FLOORS", "TRAPS",    "HUD",   "BOXES",
+    "PORTALS", "APPLES", "SNAKE",  "OVERLAYS", "SUBMIT"};
+const char *const Profiler::GPU_NAMES[NUM_GPU] = {"STATIC", "BATCH"};
+
+float Profiler::Frame::cpuTotal() const {
+  float s = 0;
+  for (float ms : cpu)
+    s += ms;
+  return s;
+}
+
+Profiler::~Profiler() {
+  if (m_queries[0][0])
+    glDeleteQueries(2 * NUM_GPU, &m_queries[0][0]);
+}
+
+void Profiler::setOn(bool on) {
+  if (on && !m_queries[0][0])
+    glGenQueries(2 * NUM_GPU, &m_queries[0][0]);
+  // Results of a previous session would land in reused history slots
+  m_slot[0] = m_slot[1] = -1;
+  m_pass = NONE;
+  m_on = on;
+}
+
+void Profiler::beginFrame() {
+  m_cur = {};
+  for (float &ms : m_cur.gpu)
+    ms = -1;
+  if (!m_on)
+    return;
+  // This set was issued two frames ago; collect it before reusing it
+  resolve(m_set);
+  m_slot[m_set] = m_head;
+  for (bool &b : m_issued[m_set])
+    b = false;
+}
+
+void Profiler::endFrame() {
+  if (!m_on)
+    return;
+  pass(NONE);
+  endGpu();
+  m_hist[m_head] = m_cur;
+  m_head = (m_head + 1) % HISTORY;
+  m_count = m_count < HISTORY ? m_count + 1 : HISTORY;
+  m_set ^= 1;
+}
+
+void Profiler::pass(Pass p) {
+  if (!m_on)
+    return;
+  Clock::time_point now = Clock::now();
+  if (m_pass != NONE)
+    m_cur.cpu[m_pass] +=
+        std::chrono::duration<float, std::milli>(now - m_passStart).count();
+  m_pass = p;
+  m_passStart = now;
+}
+
+// One query per submission and frame; a second begin of the same kind in a
+// frame is not measured
+void Profiler::beginGpu(Gpu g) {
+  if (!m_on || m_gpuActive || m_issued[m_set][g])
+    return;
+  glBeginQuery(GL_TIME_ELAPSED, m_queries[m_set][g]);
+  m_issued[m_set][g] = true;
+  m_gpuActive = true;
+}
+
+void Profiler::endGpu() {
+  if (!m_gpuActive)
+    return;
+  glEndQuery(GL_TIME_ELAPSED);
+  m_gpuActive = false;
+}
+
+void Profiler::resolve(int set) {
+  if (m_slot[set] < 0)
+    return;
+  Frame &f = m_hist[m_slot[set]];
+  for (int g = 0; g < NUM_GPU; g++) {
+    if (!m_issued[set][g]) {
+      f.gpu[g] = 0; // nothing submitted
+      continue;
+    }
+    GLint ready = 0;
+    glGetQueryObjectiv(m_queries[set][g], GL_QUERY_RESULT_AVAILABLE, &ready);
+    if (!ready)
+      continue; // stays -1 rather than stall
+    GLuint64 ns = 0;
+    glGetQueryObjectui64v(m_queries[set][g], GL_QUERY_RESULT, &ns);
+    f.gpu[g] = (float)(ns / 1e6);
+  }
+  m_slot[set] = -1;
+}
+
+static void putName(FILE *f, const char *name, const char *prefix) {
+  fputs(prefix, f);
+  for (const char *c = name; *c; c++)
+    fputc(tolower((unsigned char)*c), f);
+  fputs("_ms,", f);
+}
+
+bool Profiler::dumpCSV(const char *path) const {
+  FILE *f = fopen(path, "w");
+  if (!f)
+    return false;
+  fputs("frame,", f);
+  for (const char *n : PASS_NAMES)
+    putName(f, n, "cpu_");
+  for (const char *n : GPU_NAMES)
+    putName(f, n, "gpu_");
+  fputs("cpu_total_ms,draws,uniforms,binds,quads\n", f);
+  for (int age = m_count - 1; age >= 0; age--) {
+    const Frame &fr = frame(age);
+    fprintf(f, "%d,", m_count - 1 - age);
+    for (float ms : fr.cpu)
+      fprintf(f, "%.4f,", ms);
+    // Unresolved GPU times are left empty
+    for (float ms : fr.gpu) {
+      if (ms < 0)
+        fputc(',', f);
+      else
+        fprintf(f, "%.4f,", ms);
+    }
+    fprintf(f, "%.4f,%d,%d,%d,%d\n", fr.cpuTotal(), fr.draws, fr.uniforms,
+            fr.binds, fr.quads);
+  }
+  return fclose(f) == 0;
+}
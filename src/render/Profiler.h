@@ -0,0 +1,95 @@
+#pragma once
+#include <GL/glew.h>
+#include <chrono>
+#include <cstdint>
+
+// ─── Frame Profiler ──────────────────────────────────────────────────────────
+// Per-frame timings of the renderer, kept for the last HISTORY frames. CPU
+// time is measured per pass: the time spent building that pass's instances,
+// lap-style (pass() ends the running pass and starts the next). The batch
+// only reaches the GPU in a few submissions, so GPU time is measured per
+// submission with GL_TIME_ELAPSED queries. Queries are double-buffered: a
+// frame's results are read two frames later, and dropped rather than waited
+// for if the GPU has not finished them, so profiling never stalls the
+// pipeline. Counters (draws, uniform uploads, binds, quads) are always kept;
+// timers only run while the profiler is on.
+class Profiler {
+public:
+  enum Pass {
+    SKY,
+    CITY,
+    FLOORS,
+    TRAPS,
+    HUD,
+    BOXES,
+    PORTALS,
+    APPLES,
+    SNAKE,
+    OVERLAYS,
+    SUBMIT, // flushing the batch to GL
+    NUM_PASSES,
+    NONE = -1
+  };
+  enum Gpu { GPU_STATIC, GPU_BATCH, NUM_GPU };
+  static const char *const PASS_NAMES[NUM_PASSES];
+  static const char *const GPU_NAMES[NUM_GPU];
+
+  static constexpr int HISTORY = 240;
+
+  struct Frame {
+    float cpu[NUM_PASSES]; // ms per pass
+    float gpu[NUM_GPU];    // ms per submission, -1 until resolved
+    int draws, uniforms, binds, quads;
+    float cpuTotal() const;
+  };
+
+  Profiler() = default;
+  ~Profiler();
+  Profiler(const Profiler &) = delete;
+  Profiler &operator=(const Profiler &) = delete;
+
+  void setOn(bool on);
+  bool on() const { return m_on; }
+
+  void beginFrame();
+  void endFrame();
+  void pass(Pass p);
+  void beginGpu(Gpu g);
+  void endGpu();
+
+  // Counters of the current frame
+  void draw() { m_cur.draws++; }
+  void uniform() { m_cur.uniforms++; }
+  void bind() { m_cur.binds++; }
+  void quads(int n) { m_cur.quads += n; }
+
+  // Frames recorded so far, up to HISTORY; frame(0) is the newest
+  int frames() const { return m_count; }
+  const Frame &frame(int age) const {
+    return m_hist[(m_head - 1 - age + 2 * HISTORY) % HISTORY];
+  }
+
+  // Writes the history as CSV, oldest frame first. False on I/O failure.
+  bool dumpCSV(const char *path) const;
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  void resolve(int set);
+
+  bool m_on = false;
+  Frame m_cur = {};
+  Frame m_hist[HISTORY];
+  int m_head = 0, m_count = 0;
+
+  Pass m_pass = NONE;
+  Clock::time_point m_passStart;
+
+  // Two sets of queries, alternating by frame. m_slot says which history
+  // entry each set's results belong to, -1 when the set holds nothing.
+  GLuint m_queries[2][NUM_GPU] = {};
+  bool m_issued[2][NUM_GPU] = {};
+  int m_slot[2] = {-1, -1};
+  int m_set = 0;
+  bool m_gpuActive = false;
+};
@@ -1,37 +1,58 @@
 #include "Render.h"
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <cstdio>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <iostream>
 #include <vector>
 
-#define NANOSVG_IMPLEMENTATION
-#include "nanosvg.h"
-#define NANOSVGRAST_IMPLEMENTATION
-#include "nanosvgrast.h"
-
+// Sprites are drawn instanced: attributes 0-1 are the shared unit quad,
+// 2-5 advance once per instance (see Renderer::Inst)
 static const char *VS = R"(
 #version 330 core
 layout(location=0) in vec2 aPos;
 layout(location=1) in vec2 aUV;
-uniform mat4 uMVP;
+layout(location=2) in vec4 iXf;
+layout(location=3) in vec2 iOff;
+layout(location=4) in vec4 iCol;
+layout(location=5) in vec4 iPar;
+uniform mat4 uProj;
 out vec2 vUV;
-void main(){ vUV=aUV; gl_Position=uMVP*vec4(aPos,0,1); }
+flat out vec4 vCol;
+flat out vec4 vPar;
+void main(){
+    vUV=aUV; vCol=iCol; vPar=iPar;
+    vec2 p = mat2(iXf) * aPos + iOff;
+    gl_Position=uProj*vec4(p,0,1);
+}
 )";
 
+// Fragment shader body, specialized per pipeline by the FX (0-6 effects,
+// 7 glyph, 8 static layer copy) and TEXTURED defines put in front of it
 static const char *FS = R"(
-#version 330 core
 in  vec2 vUV;
+flat in vec4 vCol;
+flat in vec4 vPar; // round, time, unused, texture layer
 out vec4 FragColor;
-uniform vec4  uColor;
-uniform float uRound; 
-uniform float uTime;
-uniform int   uFx;
-uniform int   uUseTex;
-uniform sampler2D uTex;
+uniform sampler2DArray uTex;
+uniform sampler2D uStatic;
+uniform sampler2DArray uFont; // one glyph distance field per layer
 
 void main(){
+#if FX == 8
+    // Copy of the cached static layer, stored bottom-up
+    FragColor = texture(uStatic, vec2(vUV.x, 1.0 - vUV.y));
+#elif FX == 7
+    // Glyph: distance to the lit font pixels, in font pixels, positive
+    // outside. Antialias over one screen pixel at any scale.
+    float d = 0.5 - texture(uFont, vec3(vUV, vPar.w)).r;
+    float w = max(fwidth(d), 1e-4);
+    FragColor = vec4(vCol.rgb, vCol.a * clamp(0.5 - d / w, 0.0, 1.0));
+#else
+    float uRound = vPar.x;
+    float uTime  = vPar.y;
     vec2  p  = vUV - 0.5;
     float a  = 1.0;
 
@@ -42,59 +63,57 @@ void main(){
         a = 1.0 - smoothstep(-0.02, 0.02, d);
     }
 
-    vec4 c = uColor;
-
-    if(uFx == 4){
-        float t = vUV.y;
-        vec3 top = vec3(0.53, 0.81, 0.92);
-        vec3 bot = vec3(0.77, 0.91, 0.97);
-        c.rgb = mix(top, bot, t);
-        c.a   = 1.0;
-    }
-    if(uFx == 5){
-        float grain = 0.5 + 0.5*sin(vUV.y * 28.0 + vUV.x * 3.0);
-        c.rgb = mix(c.rgb, c.rgb * 1.15, grain * 0.35);
-    }
-    if(uFx == 1){
-        // Clockwise spiral: negate time to flip rotation direction
-        float angle = atan(p.y, p.x) - uTime * 2.8;
-        float r2    = length(p);
-        float spiral= 0.5 + 0.5*sin(angle * 4.0 - r2 * 18.0);
-        c.rgb += vec3(0.6, 0.5, 1.0) * spiral * (1.0 - r2*2.0) * 0.55;
-        c.rgb = clamp(c.rgb, 0.0, 1.0);
-    }
-    if(uFx == 2){
-        float shine = smoothstep(0.0, 0.22, 0.30 - length(p - vec2(-0.13,-0.16)));
-        c.rgb += shine * 0.5;
-    }
-    if(uFx == 3){
-        float spots = smoothstep(0.0, 0.06, 0.09 - length(mod(p + 0.25, 0.25) - 0.125));
-        c.rgb = mix(c.rgb, c.rgb * 0.62, spots);
-    }
-    if(uFx == 6){
-        float hi = smoothstep(0.42, 0.50, vUV.y);
-        c.rgb = mix(c.rgb, c.rgb * 1.22, hi);
-        float sh = smoothstep(0.0, 0.08, vUV.y);
-        c.rgb = mix(c.rgb * 0.70, c.rgb, sh);
-    }
+    vec4 c = vCol;
+
+#if FX == 4
+    float t = vUV.y;
+    vec3 top = vec3(0.53, 0.81, 0.92);
+    vec3 bot = vec3(0.77, 0.91, 0.97);
+    c.rgb = mix(top, bot, t);
+    c.a   = 1.0;
+#elif FX == 5
+    float grain = 0.5 + 0.5*sin(vUV.y * 28.0 + vUV.x * 3.0);
+    c.rgb = mix(c.rgb, c.rgb * 1.15, grain * 0.35);
+#elif FX == 1
+    // Clockwise spiral: negate time to flip rotation direction
+    float angle = atan(p.y, p.x) - uTime * 2.8;
+    float r2    = length(p);
+    float spiral= 0.5 + 0.5*sin(angle * 4.0 - r2 * 18.0);
+    c.rgb += vec3(0.6, 0.5, 1.0) * spiral * (1.0 - r2*2.0) * 0.55;
+    c.rgb = clamp(c.rgb, 0.0, 1.0);
+#elif FX == 2
+    float shine = smoothstep(0.0, 0.22, 0.30 - length(p - vec2(-0.13,-0.16)));
+    c.rgb += shine * 0.5;
+#elif FX == 3
+    float spots = smoothstep(0.0, 0.06, 0.09 - length(mod(p + 0.25, 0.25) - 0.125));
+    c.rgb = mix(c.rgb, c.rgb * 0.62, spots);
+#elif FX == 6
+    float hi = smoothstep(0.42, 0.50, vUV.y);
+    c.rgb = mix(c.rgb, c.rgb * 1.22, hi);
+    float sh = smoothstep(0.0, 0.08, vUV.y);
+    c.rgb = mix(c.rgb * 0.70, c.rgb, sh);
+#endif
 
     if(uRound > 0.5){
         float v = 1.0 - 0.18*dot(p*1.6, p*1.6);
         c.rgb *= max(v, 0.75);
     }
 
-    if (uUseTex == 1) {
-        vec4 texCol = texture(uTex, vUV);
-        FragColor = texCol * vec4(c.rgb, c.a * a);
-    } else {
-        FragColor = vec4(c.rgb, c.a * a);
-    }
+#if TEXTURED
+    // Flat quads in a textured run sample the sheet's white layer
+    vec4 texCol = texture(uTex, vec3(vUV, vPar.w));
+    FragColor = texCol * vec4(c.rgb, c.a * a);
+#else
+    FragColor = vec4(c.rgb, c.a * a);
+#endif
+#endif
 }
 )";
 
-static GLuint mkSh(GLenum t, const char *src) {
+static GLuint mkSh(GLenum t, const char *src, const char *prelude = "") {
   GLuint s = glCreateShader(t);
-  glShaderSource(s, 1, &src, nullptr);
+  const char *srcs[] = {prelude, src};
+  glShaderSource(s, 2, srcs, nullptr);
   glCompileShader(s);
   int ok;
   glGetShaderiv(s, GL_COMPILE_STATUS, &ok);
@@ -107,40 +126,42 @@ static GLuint mkSh(GLenum t, const char *src) {
 }
 
 Renderer::Renderer()
-    : m_prog(0), m_vao(0), m_vbo(0), m_ebo(0), m_ox(0), m_texApple(0),
-      m_texBlock(0), m_texTrap(0), m_texPortal(0), m_texSnakeHead(0),
-      m_texSnakeMid(0), m_texSnakeTail(0) {}
+    : m_vs(0), m_curProg(0), m_curTex(), m_vao(0), m_vbo(0), m_ebo(0),
+      m_instVbo(0), m_instCap(0), m_projGen(1), m_staticFbo(0), m_staticTex(0),
+      m_staticW(0), m_staticH(0), m_staticKey(), m_staticValid(false),
+      m_fontTex(0), m_ox(0) {}
 
 Renderer::~Renderer() {
-  if (m_prog)
-    glDeleteProgram(m_prog);
+  for (auto &fx : m_pipes)
+    for (Pipeline &p : fx)
+      if (p.prog)
+        glDeleteProgram(p.prog);
+  if (m_vs)
+    glDeleteShader(m_vs);
   if (m_vao)
     glDeleteVertexArrays(1, &m_vao);
   if (m_vbo)
     glDeleteBuffers(1, &m_vbo);
   if (m_ebo)
     glDeleteBuffers(1, &m_ebo);
+  if (m_instVbo)
+    glDeleteBuffers(1, &m_instVbo);
+  if (m_staticFbo)
+    glDeleteFramebuffers(1, &m_staticFbo);
+  if (m_staticTex)
+    glDeleteTextures(1, &m_staticTex);
+  if (m_fontTex)
+    glDeleteTextures(1, &m_fontTex);
 }
 
 void Renderer::init(int width, int height) {
   m_W = width;
   m_H = height;
 
-  GLuint vs = mkSh(GL_VERTEX_SHADER, VS), fs = mkSh(GL_FRAGMENT_SHADER, FS);
-  m_prog = glCreateProgram();
-  glAttachShader(m_prog, vs);
-  glAttachShader(m_prog, fs);
-  glLinkProgram(m_prog);
-  glDeleteShader(vs);
-  glDeleteShader(fs);
-  m_lMVP = glGetUniformLocation(m_prog, "uMVP");
-  m_lCol = glGetUniformLocation(m_prog, "uColor");
-  m_lRnd = glGetUniformLocation(m_prog, "uRound");
-  m_lTime = glGetUniformLocation(m_prog, "uTime");
-  m_lFx = glGetUniformLocation(m_prog, "uFx");
-  m_lUseTex = glGetUniformLocation(m_prog, "uUseTex");
-  glUseProgram(m_prog);
-  glUniform1i(glGetUniformLocation(m_prog, "uTex"), 0);
+  // One vertex shader; the fragment variants are linked against it on first
+  // use (see pipeline())
+  m_vs = mkSh(GL_VERTEX_SHADER, VS);
+  buildFont();
 
   float v[] = {0, 0, 0, 0, 1, 0, 1, 0, 1, 1, 1, 1, 0, 1, 0, 1};
   unsigned idx[] = {0, 1, 2, 0, 2, 3};
@@ -156,102 +177,171 @@ void Renderer::init(int width, int height) {
   glEnableVertexAttribArray(0);
   glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 16, (void *)8);
   glEnableVertexAttribArray(1);
-  glBindVertexArray(0);
-
-  // Load SVG textures from assets/
-  m_texApple = loadSVGTexture("assets/apple.svg", 128, 128);
-  m_texBlock = loadSVGTexture("assets/block.svg", 128, 128);
-  m_texTrap = loadSVGTexture("assets/trap.svg", 128, 128);
-  m_texPortal = loadSVGTexture("assets/vortex.svg", 128, 128);
-  m_texSnakeHead = loadSVGTexture("assets/snake/head.svg", 256, 256);
-  m_texSnakeMid = loadSVGTexture("assets/snake/mid.svg", 256, 256);
-  m_texSnakeTail = loadSVGTexture("assets/snake/tail.svg", 256, 256);
-}
-
-GLuint Renderer::loadSVGTexture(const char *filepath, int texW, int texH) {
-  NSVGimage *img = nsvgParseFromFile(filepath, "px", 96.0f);
-  if (!img) {
-    std::cerr << "Failed to load SVG: " << filepath << "\n";
-    return 0;
+  // Per-instance attributes; flush() points them at each run
+  glGenBuffers(1, &m_instVbo);
+  for (int a = 2; a <= 5; a++) {
+    glEnableVertexAttribArray(a);
+    glVertexAttribDivisor(a, 1);
   }
-  NSVGrasterizer *rast = nsvgCreateRasterizer();
-  std::vector<unsigned char> pixels(texW * texH * 4, 0);
-  float scaleX = texW / img->width;
-  float scaleY = texH / img->height;
-  float scale = std::min(scaleX, scaleY);
-  nsvgRasterize(rast, img, 0, 0, scale, pixels.data(), texW, texH, texW * 4);
-  nsvgDeleteRasterizer(rast);
-  nsvgDelete(img);
-
-  GLuint tex;
-  glGenTextures(1, &tex);
-  glBindTexture(GL_TEXTURE_2D, tex);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, texW, texH, 0, GL_RGBA,
-               GL_UNSIGNED_BYTE, pixels.data());
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-  glBindTexture(GL_TEXTURE_2D, 0);
-  return tex;
+  glBindVertexArray(0);
+  m_batch.reserve(4096);
+
+  // Sprites from assets/, in Spr order, sized for a full-size cell until
+  // the first frame knows the board
+  m_sheet.init({"assets/apple.svg", "assets/block.svg", "assets/trap.svg",
+                "assets/vortex.svg", "assets/snake/head.svg",
+                "assets/snake/mid.svg", "assets/snake/tail.svg"},
+               (float)CELL);
 }
 
 void Renderer::resize(int w, int h) {
+  if (w != m_W || h != m_H)
+    m_projGen++;
   m_W = w;
   m_H = h;
   glViewport(0, 0, w, h);
   m_proj = glm::ortho(0.f, (float)w, (float)h, 0.f, -1.f, 1.f);
 }
 
-void Renderer::dR(float px, float py, float w, float h, const Opt &o) {
-  glm::mat4 m = glm::translate(glm::mat4(1.0f), {px, py, 0});
-  m = glm::scale(m, {w, h, 1});
-  glm::mat4 mvp = m_proj * m;
-  glUseProgram(m_prog);
-  glUniformMatrix4fv(m_lMVP, 1, GL_FALSE, glm::value_ptr(mvp));
-  glUniform4fv(m_lCol, 1, glm::value_ptr(o.c));
-  glUniform1f(m_lRnd, o.r);
-  glUniform1f(m_lTime, o.t);
-  glUniform1i(m_lFx, o.fx);
-  if (o.tex) {
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, o.tex);
-    glUniform1i(m_lUseTex, 1);
-  } else {
-    glUniform1i(m_lUseTex, 0);
+// ─── Pipelines and GL state ──────────────────────────────────────────────────
+Renderer::Pipeline &Renderer::pipeline(int fx, bool textured) {
+  Pipeline &p = m_pipes[fx][textured];
+  if (p.prog)
+    return p;
+  char prelude[64];
+  snprintf(prelude, sizeof(prelude),
+           "#version 330 core\n#define FX %d\n#define TEXTURED %d\n", fx,
+           (int)textured);
+  GLuint fs = mkSh(GL_FRAGMENT_SHADER, FS, prelude);
+  p.prog = glCreateProgram();
+  glAttachShader(p.prog, m_vs);
+  glAttachShader(p.prog, fs);
+  glLinkProgram(p.prog);
+  glDetachShader(p.prog, m_vs);
+  glDeleteShader(fs);
+  p.lProj = glGetUniformLocation(p.prog, "uProj");
+  useProgram(p);
+  glUniform1i(glGetUniformLocation(p.prog, "uTex"), 0);
+  glUniform1i(glGetUniformLocation(p.prog, "uStatic"), 1);
+  glUniform1i(glGetUniformLocation(p.prog, "uFont"), 2);
+  for (int i = 0; i < 3; i++)
+    m_prof.uniform();
+  return p;
+}
+
+// Binds p and brings its projection up to date, skipping what is current
+void Renderer::useProgram(Pipeline &p) {
+  if (m_curProg != p.prog) {
+    glUseProgram(p.prog);
+    m_curProg = p.prog;
+    m_prof.bind();
   }
+  if (p.projGen != m_projGen) {
+    glUniformMatrix4fv(p.lProj, 1, GL_FALSE, glm::value_ptr(m_proj));
+    p.projGen = m_projGen;
+    m_prof.uniform();
+  }
+}
+
+void Renderer::bindTex(int unit, GLenum target, GLuint tex) {
+  if (m_curTex[unit] == tex)
+    return;
+  glActiveTexture(GL_TEXTURE0 + unit);
+  glBindTexture(target, tex);
+  m_curTex[unit] = tex;
+  m_prof.bind();
+}
+
+// Forgets the tracked state, for when GL calls outside the tracker (other
+// code, or the sprite sheet swapping textures) may have changed it
+void Renderer::resetState() {
+  m_curProg = 0;
+  for (GLuint &t : m_curTex)
+    t = ~0u;
+}
+
+// ─── Sprite batch ────────────────────────────────────────────────────────────
+// dR/dRot only append instances; flush() uploads the frame's instances into
+// the streaming buffer once and draws each run of consecutive instances that
+// share an fx with one instanced call. Every sprite lives in m_sheet and flat
+// quads can sample its white layer, so textured and flat quads share runs.
+void Renderer::push(const Inst &q, const Opt &o) {
+  Inst i = q;
+  i.c[0] = o.c.r;
+  i.c[1] = o.c.g;
+  i.c[2] = o.c.b;
+  i.c[3] = o.c.a;
+  i.r = o.r;
+  i.t = o.t;
+  i.pad = 0;
+  i.layer = (float)(o.spr >= 0 ? o.spr : m_sheet.whiteLayer());
+  if (m_runs.empty() || m_runs.back().fx != o.fx)
+    m_runs.push_back({o.fx, false, (int)m_batch.size(), 0});
+  m_runs.back().textured |= o.spr >= 0 && o.fx < FX_GLYPH;
+  m_runs.back().count++;
+  m_batch.push_back(i);
+}
+
+void Renderer::flush() {
+  if (m_batch.empty())
+    return;
   glBindVertexArray(m_vao);
-  glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+  glBindBuffer(GL_ARRAY_BUFFER, m_instVbo);
+  // Orphan the previous storage so the driver never waits on last frame
+  GLsizeiptr bytes = (GLsizeiptr)(m_batch.size() * sizeof(Inst));
+  if (bytes > m_instCap)
+    m_instCap = std::max(bytes, m_instCap * 2);
+  glBufferData(GL_ARRAY_BUFFER, m_instCap, nullptr, GL_STREAM_DRAW);
+  glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, m_batch.data());
+  m_prof.quads((int)m_batch.size());
+  for (const Run &run : m_runs) {
+    useProgram(pipeline(run.fx, run.textured));
+    if (run.fx == FX_STATIC)
+      bindTex(1, GL_TEXTURE_2D, m_staticTex);
+    else if (run.fx == FX_GLYPH)
+      bindTex(2, GL_TEXTURE_2D_ARRAY, m_fontTex);
+    else if (run.textured)
+      bindTex(0, GL_TEXTURE_2D_ARRAY, m_sheet.texture());
+    size_t base = run.first * sizeof(Inst);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(Inst),
+                          (void *)(base + offsetof(Inst, xf)));
+    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(Inst),
+                          (void *)(base + offsetof(Inst, off)));
+    glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(Inst),
+                          (void *)(base + offsetof(Inst, c)));
+    glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, sizeof(Inst),
+                          (void *)(base + offsetof(Inst, r)));
+    glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, run.count);
+    m_prof.draw();
+  }
   glBindVertexArray(0);
+  m_batch.clear();
+  m_runs.clear();
 }
 
-// Draw a square centered at (cxp,cyp), with size sz x sz, rotated by angle
-// (radians)
+void Renderer::dR(float px, float py, float w, float h, const Opt &o) {
+  Inst q{};
+  q.xf[0] = w;
+  q.xf[3] = h;
+  q.off[0] = px;
+  q.off[1] = py;
+  push(q, o);
+}
+
+// Draw a w x h rect centered at (cxp,cyp), rotated by angle (radians)
 void Renderer::dRot(float cxp, float cyp, float w, float h, float angle,
                     const Opt &o) {
-  // Build MVP: translate to center, rotate, scale, translate back so quad
-  // [0,1]^2 is centered at origin
-  glm::mat4 m = glm::translate(glm::mat4(1.0f), {cxp, cyp, 0.0f});
-  m = glm::rotate(m, angle, {0.0f, 0.0f, 1.0f});
-  m = glm::scale(m, {w, h, 1.0f});
-  m = glm::translate(m, {-0.5f, -0.5f, 0.0f}); // center the unit quad
-  glm::mat4 mvp = m_proj * m;
-  glUseProgram(m_prog);
-  glUniformMatrix4fv(m_lMVP, 1, GL_FALSE, glm::value_ptr(mvp));
-  glUniform4fv(m_lCol, 1, glm::value_ptr(o.c));
-  glUniform1f(m_lRnd, o.r);
-  glUniform1f(m_lTime, o.t);
-  glUniform1i(m_lFx, o.fx);
-  if (o.tex) {
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, o.tex);
-    glUniform1i(m_lUseTex, 1);
-  } else {
-    glUniform1i(m_lUseTex, 0);
-  }
-  glBindVertexArray(m_vao);
-  glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-  glBindVertexArray(0);
+  // Columns of rotate * scale; the offset puts the quad's center at (cxp,cyp)
+  float c = cosf(angle), s = sinf(angle);
+  float ax = w * c, ay = w * s, bx = -h * s, by = h * c;
+  Inst q{};
+  q.xf[0] = ax;
+  q.xf[1] = ay;
+  q.xf[2] = bx;
+  q.xf[3] = by;
+  q.off[0] = cxp - 0.5f * (ax + bx);
+  q.off[1] = cyp - 0.5f * (ay + by);
+  push(q, o);
 }
 
 void Renderer::dC(int gx, int gy, float sz, const Opt &o) {
@@ -296,6 +386,7 @@ static const uint8_t FONT[][7] = {
     {0x1F, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}, // 34 H
     {0x01, 0x02, 0x04, 0x08, 0x10, 0x00, 0x00}, // 35 /
     {0x0E, 0x11, 0x11, 0x17, 0x11, 0x11, 0x0E}, // 36 G
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C}, // 37 .
 };
 
 static int fi(char c) {
@@ -356,20 +447,76 @@ static int fi(char c) {
     return 35;
   case 'G':
     return 36;
+  case '.':
+    return 37;
   }
   return -1;
 }
 
+// ─── Glyph atlas ─────────────────────────────────────────────────────────────
+// Each FONT glyph becomes one layer of a signed distance field: the 5x7
+// pixels plus one pixel of padding, GLYPH_RES texels per font pixel. A texel
+// stores 0.5 minus its distance (in font pixels, positive outside) to the lit
+// pixels, clamped to one pixel either way, so a glyph scales to any `sc` as a
+// single quad with an antialiased edge.
+static constexpr int GLYPH_RES = 4;
+static constexpr int GLYPH_W = (5 + 2) * GLYPH_RES;
+static constexpr int GLYPH_H = (7 + 2) * GLYPH_RES;
+static constexpr int NUM_GLYPHS = sizeof(FONT) / sizeof(FONT[0]);
+
+void Renderer::buildFont() {
+  std::vector<unsigned char> sdf((size_t)GLYPH_W * GLYPH_H * NUM_GLYPHS);
+  unsigned char *out = sdf.data();
+  for (int g = 0; g < NUM_GLYPHS; g++) {
+    // Font pixel (x,y) of the padded glyph, lit or not
+    auto lit = [&](int x, int y) {
+      return x >= 1 && x <= 5 && y >= 1 && y <= 7 &&
+             (FONT[g][y - 1] & (1 << (5 - x)));
+    };
+    for (int ty = 0; ty < GLYPH_H; ty++) {
+      for (int tx = 0; tx < GLYPH_W; tx++) {
+        float u = (tx + 0.5f) / GLYPH_RES, v = (ty + 0.5f) / GLYPH_RES;
+        bool in = lit((int)u, (int)v);
+        // Nearest pixel of the other kind; the padding is never lit
+        float best = 1.f;
+        for (int y = 0; y < 9; y++) {
+          for (int x = 0; x < 7; x++) {
+            if (lit(x, y) == in)
+              continue;
+            float dx = std::max({x - u, 0.f, u - (x + 1)});
+            float dy = std::max({y - v, 0.f, v - (y + 1)});
+            best = std::min(best, sqrtf(dx * dx + dy * dy));
+          }
+        }
+        float d = in ? -best : best;
+        *out++ = (unsigned char)std::lround((0.5f - 0.5f * d) * 255.f);
+      }
+    }
+  }
+  glGenTextures(1, &m_fontTex);
+  glActiveTexture(GL_TEXTURE2);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, m_fontTex);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_R8, GLYPH_W, GLYPH_H, NUM_GLYPHS, 0,
+               GL_RED, GL_UNSIGNED_BYTE, sdf.data());
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glActiveTexture(GL_TEXTURE0);
+}
+
+// One quad per glyph, padded by a font pixel on each side for the edge
 void Renderer::dCh(char c, float px, float py, float sc, glm::vec4 col) {
   int i = fi(c);
   if (i < 0)
     return;
   Opt o;
   o.c = col;
-  for (int r = 0; r < 7; r++)
-    for (int b = 0; b < 5; b++)
-      if (FONT[i][r] & (1 << (4 - b)))
-        dR(px + b * sc, py + r * sc, sc, sc, o);
+  o.fx = FX_GLYPH;
+  o.spr = i;
+  dR(px - sc, py - sc, 7 * sc, 9 * sc, o);
 }
 
 float Renderer::dStr(const char *s, float px, float py, float sc,
@@ -436,10 +583,10 @@ void Renderer::drawTile(int gx, int gy) {
   sh.r = 0.15f;
   dR(px + 4, py + 5, m_cell, m_cell, sh);
   // SVG block texture on top — white tint = full color passthrough
-  if (m_texBlock) {
+  if (hasSpr(SPR_BLOCK)) {
     Opt svgo;
     svgo.c = {1, 1, 1, 1};
-    svgo.tex = m_texBlock;
+    svgo.spr = SPR_BLOCK;
     dR(px, py, m_cell, m_cell, svgo);
   } else {
     // Fallback: manual brick look
@@ -459,7 +606,7 @@ void Renderer::drawApple(int gx, int gy, float t) {
   float sz = m_cell * 0.72f;
   float px = cx(gx) + (m_cell - sz) * .5f;
   float py = cy(gy) + (m_cell - sz) * .5f + bob;
-  if (m_texApple) {
+  if (hasSpr(SPR_APPLE)) {
     // Subtle drop shadow
     Opt sh;
     sh.c = {0, 0, 0, 0.20f};
@@ -468,7 +615,7 @@ void Renderer::drawApple(int gx, int gy, float t) {
     // SVG apple
     Opt o;
     o.c = {1, 1, 1, 1};
-    o.tex = m_texApple;
+    o.spr = SPR_APPLE;
     dR(px, py, sz, sz, o);
   } else {
     // Fallback
@@ -487,7 +634,7 @@ void Renderer::drawApple(int gx, int gy, float t) {
 
 void Renderer::drawPortal(int gx, int gy, float t) {
   float sz = m_cell * 0.86f;
-  if (m_texPortal) {
+  if (hasSpr(SPR_PORTAL)) {
     // Pulsing glow ring behind
     Opt glow;
     glow.c = {0.45f, 0.30f, 0.80f, 0.5f};
@@ -497,7 +644,7 @@ void Renderer::drawPortal(int gx, int gy, float t) {
     // SVG vortex — true clockwise physical rotation based on time
     Opt o;
     o.c = {1, 1, 1, 1};
-    o.tex = m_texPortal;
+    o.spr = SPR_PORTAL;
     o.fx = 0; // Remove the twinkling shader effect
     // Clockwise rotation (angle increases)
     float angle = t * 2.5f;
@@ -529,11 +676,11 @@ void Renderer::drawTrap(int gx, int gy, float angle) {
   float px = cx(gx), py = cy(gy);
   float cxp = px + m_cell * 0.5f;
   float cyp = py + m_cell * 0.5f;
-  if (m_texTrap) {
+  if (hasSpr(SPR_TRAP)) {
     // No background paint, no animation — SVG fills the tile exactly
     Opt o;
     o.c = {1, 1, 1, 1};
-    o.tex = m_texTrap;
+    o.spr = SPR_TRAP;
     dRot(cxp, cyp, m_cell, m_cell, angle, o);
   } else {
     // Fallback: solid red danger tile
@@ -582,14 +729,14 @@ void Renderer::drawSnakeSegmentF(float gx, float gy, float sz, glm::vec4 col,
   float cx = px + m_cell * 0.5f;
   float cy = py + m_cell * 0.5f;
 
-  // Determine which SVG texture and rotation angle to use
-  GLuint segTex = m_texSnakeMid;
+  // Determine which SVG sprite and rotation angle to use
+  int seg = SPR_MID;
   if (isHead)
-    segTex = m_texSnakeHead;
+    seg = SPR_HEAD;
   if (isTail)
-    segTex = m_texSnakeTail;
+    seg = SPR_TAIL;
 
-  if (segTex) {
+  if (hasSpr(seg)) {
     // Drop shadow
     Opt sh;
     sh.c = {0, 0, 0, 0.20f};
@@ -598,7 +745,7 @@ void Renderer::drawSnakeSegmentF(float gx, float gy, float sz, glm::vec4 col,
     // Draw the SVG rotated to face the direction of travel
     Opt o;
     o.c = {1, 1, 1, 1};
-    o.tex = segTex;
+    o.spr = seg;
     dRot(cx, cy, sz, sz, angle, o);
   } else {
     // Fallback procedural
@@ -672,18 +819,299 @@ void Renderer::drawButton(float px, float py, float w, float h, glm::vec4 bg,
   dStr(label, px + (w - tw) * .5f, py + (h - 7 * sc) * .5f, sc, tc);
 }
 
+// ─── Profiler overlay ────────────────────────────────────────────────────────
+static const glm::vec4 PROF_PASS[Profiler::NUM_PASSES] = {
+    {0.53f, 0.81f, 0.92f, 1}, {0.47f, 0.67f, 0.78f, 1},
+    {0.65f, 0.55f, 0.40f, 1}, {0.75f, 0.75f, 0.80f, 1},
+    {0.96f, 0.96f, 0.96f, 1}, {0.85f, 0.58f, 0.25f, 1},
+    {0.60f, 0.45f, 0.95f, 1}, {0.90f, 0.20f, 0.20f, 1},
+    {0.30f, 0.80f, 0.20f, 1}, {0.98f, 0.82f, 0.12f, 1},
+    {0.95f, 0.40f, 0.70f, 1}};
+static const glm::vec4 PROF_GPU[Profiler::NUM_GPU] = {
+    {0.30f, 0.60f, 0.95f, 1}, {0.95f, 0.55f, 0.20f, 1}};
+
+void Renderer::toggleProfiler() { m_prof.setOn(!m_prof.on()); }
+
+bool Renderer::dumpProfile(const char *path) const {
+  return m_prof.dumpCSV(path);
+}
+
+// Averages over the recorded frames, the latest counters, and one graph of
+// stacked per-pass CPU times and one of per-submission GPU times, a column
+// per frame with the newest on the right
+void Renderer::drawProfiler() {
+  int n = m_prof.frames();
+  if (n == 0)
+    return;
+  float cpu[Profiler::NUM_PASSES] = {}, gpu[Profiler::NUM_GPU] = {};
+  int gpuN[Profiler::NUM_GPU] = {};
+  float cpuMax = 0.01f, gpuMax = 0.01f;
+  for (int a = 0; a < n; a++) {
+    const Profiler::Frame &f = m_prof.frame(a);
+    for (int p = 0; p < Profiler::NUM_PASSES; p++)
+      cpu[p] += f.cpu[p] / n;
+    cpuMax = std::max(cpuMax, f.cpuTotal());
+    float g = 0;
+    for (int k = 0; k < Profiler::NUM_GPU; k++) {
+      if (f.gpu[k] >= 0) {
+        gpu[k] += f.gpu[k];
+        gpuN[k]++;
+        g += f.gpu[k];
+      }
+    }
+    gpuMax = std::max(gpuMax, g);
+  }
+  float cpuAvg = 0, gpuAvg = 0;
+  for (float ms : cpu)
+    cpuAvg += ms;
+  for (int k = 0; k < Profiler::NUM_GPU; k++) {
+    gpu[k] = gpuN[k] ? gpu[k] / gpuN[k] : 0;
+    gpuAvg += gpu[k];
+  }
+
+  const float sc = 1.2f, lh = 12, gh = 48, pad = 8;
+  const int rows = (Profiler::NUM_PASSES + Profiler::NUM_GPU + 1) / 2;
+  const float pw = Profiler::HISTORY + 2 * pad;
+  const float ph = 2 * pad + 3 * lh + 2 * (gh + 4) + lh / 2 + rows * lh;
+  float x = m_W - pw - 8, y = HUD_H + 8;
+  Opt bg;
+  bg.c = {0.08f, 0.09f, 0.12f, 0.85f};
+  bg.r = 0.04f;
+  dR(x, y, pw, ph, bg);
+  x += pad;
+  y += pad;
+
+  char buf[64];
+  const Profiler::Frame &last = m_prof.frame(0);
+  snprintf(buf, sizeof(buf), "DRAWS %d UNIF %d BINDS %d INST %d", last.draws,
+           last.uniforms, last.binds, last.quads);
+  dStr(buf, x, y, sc, HUD_TF);
+  y += lh;
+
+  // One graph: a column per frame, get(frame, k) stacked for k < parts
+  auto graph = [&](const char *name, float avg, float max, int parts,
+                   const glm::vec4 *cols, auto get) {
+    snprintf(buf, sizeof(buf), "%s %.3f MS  MAX %.3f", name, avg, max);
+    dStr(buf, x, y, sc, HUD_TF);
+    y += lh;
+    Opt gb;
+    gb.c = {0, 0, 0, 0.5f};
+    dR(x, y, (float)Profiler::HISTORY, gh, gb);
+    for (int a = 0; a < n; a++) {
+      const Profiler::Frame &f = m_prof.frame(a);
+      float colX = x + Profiler::HISTORY - 1 - a, base = y + gh;
+      for (int k = 0; k < parts; k++) {
+        float h = std::max(0.f, get(f, k)) / max * gh;
+        if (h < 0.25f)
+          continue;
+        Opt bar;
+        bar.c = cols[k];
+        dR(colX, base - h, 1, h, bar);
+        base -= h;
+      }
+    }
+    y += gh + 4;
+  };
+  graph("CPU", cpuAvg, cpuMax, Profiler::NUM_PASSES, PROF_PASS,
+        [](const Profiler::Frame &f, int k) { return f.cpu[k]; });
+  graph("GPU", gpuAvg, gpuMax, Profiler::NUM_GPU, PROF_GPU,
+        [](const Profiler::Frame &f, int k) { return f.gpu[k]; });
+
+  // Legend with the average of each part, in two columns
+  y += lh / 2;
+  auto legend = [&](int i, const char *name, float ms, glm::vec4 col) {
+    float lx = x + (i % 2) * (Profiler::HISTORY / 2),
+          ly = y + (i / 2) * lh;
+    Opt sw;
+    sw.c = col;
+    dR(lx, ly, 7 * sc, 7 * sc, sw);
+    snprintf(buf, sizeof(buf), "%s %.3f", name, ms);
+    dStr(buf, lx + 10 * sc, ly, sc, HUD_TF);
+  };
+  int i = 0;
+  for (int p = 0; p < Profiler::NUM_PASSES; p++, i++)
+    legend(i, Profiler::PASS_NAMES[p], cpu[p], PROF_PASS[p]);
+  for (int k = 0; k < Profiler::NUM_GPU; k++, i++)
+    legend(i, Profiler::GPU_NAMES[k], gpu[k], PROF_GPU[k]);
+}
+
+// ─── Latency overlay ─────────────────────────────────────────────────────────
+bool Renderer::toggleLatency(const char *logPath) {
+  return m_lat.setOn(!m_lat.on(), logPath);
+}
+
+void Renderer::presented(
+    const std::vector<LatencyTracer::Clock::time_point> &inputs) {
+  m_lat.presented(inputs);
+}
+
+// Stats and a histogram of input-to-present and input-to-GPU-done times
+void Renderer::drawLatency() {
+  const float sc = 1.2f, lh = 12, gh = 32, pad = 8, bw = 4;
+  const float pw = LatencyTracer::BUCKETS * bw + 2 * pad + 64;
+  const float ph = 2 * pad + lh + LatencyTracer::NUM_SERIES * (lh + gh + 4);
+  float x = 8, y = HUD_H + 8;
+  Opt bg;
+  bg.c = {0.08f, 0.09f, 0.12f, 0.85f};
+  bg.r = 0.04f;
+  dR(x, y, pw, ph, bg);
+  x += pad;
+  y += pad;
+  dStr("INPUT LATENCY MS", x, y, sc, HUD_TF);
+  y += lh;
+
+  char buf[64];
+  for (int s = 0; s < LatencyTracer::NUM_SERIES; s++) {
+    auto series = (LatencyTracer::Series)s;
+    LatencyTracer::Stats st = m_lat.stats(series);
+    snprintf(buf, sizeof(buf), "%s MIN %.1f P50 %.1f P99 %.1f",
+             LatencyTracer::SERIES_NAMES[s], st.min, st.p50, st.p99);
+    dStr(buf, x, y, sc, HUD_TF);
+    y += lh;
+    const int *hist = m_lat.histogram(series);
+    int peak = *std::max_element(hist, hist + LatencyTracer::BUCKETS);
+    Opt gb;
+    gb.c = {0, 0, 0, 0.5f};
+    dR(x, y, LatencyTracer::BUCKETS * bw, gh, gb);
+    for (int b = 0; b < LatencyTracer::BUCKETS && peak; b++) {
+      float h = (float)hist[b] / peak * gh;
+      if (h <= 0)
+        continue;
+      Opt bar;
+      bar.c = PROF_GPU[s];
+      dR(x + b * bw, y + gh - h, bw - 1, h, bar);
+    }
+    snprintf(buf, sizeof(buf), "N %d", st.n);
+    dStr(buf, x + LatencyTracer::BUCKETS * bw + 6, y + gh - 7 * sc, sc, DIM);
+    y += gh + 4;
+  }
+}
+
+// Death and win overlays fade in over 1 / FADE_RATE seconds
+static constexpr float FADE_RATE = 2.5f;
+
+Renderer::Motion Renderer::motion(const GameState &state) const {
+  if (m_prof.on() || m_lat.on() || m_sheet.pending())
+    return Motion::FULL;
+  if (state.moveTimer < 1.0f ||
+      (state.dead && state.deadTimer * FADE_RATE < 1) ||
+      (state.won && state.winTimer * FADE_RATE < 1))
+    return Motion::FULL;
+  if (!state.appleCells.empty())
+    return Motion::AMBIENT;
+  for (V2 p : state.portalCells)
+    if (state.at(p.x, p.y) == T::Portal)
+      return Motion::AMBIENT;
+  return Motion::NONE;
+}
+
+// Fits the board plus one cell of padding on each side between the HUD and
+// the footer
+void Renderer::layoutBoard(const GameState &state) {
+  float availableHeight = m_H - HUD_H - BOT_H;
+  float maxCellW = (float)m_W / (state.w + 2.0f);
+  float maxCellH = availableHeight / (state.h + 2.0f);
+  m_cell = std::min({maxCellW, maxCellH, (float)CELL});
+
+  m_ox = (m_W - state.w * m_cell) / 2;
+  m_oy = HUD_H + (availableHeight - state.h * m_cell) / 2;
+}
+
+// Everything behind the moving pieces that only changes with the level, the
+// window size or the sprite rasters. Floors and traps never change during
+// play: traps are drawn even under boxes, so boxes moving on and off them do
+// not touch this layer.
+void Renderer::drawStatic(const GameState &state) {
+  StaticKey key{state.layoutGen, m_W, m_H, state.w, state.h,
+                m_sheet.texture()};
+  if (!m_staticValid || !(key == m_staticKey)) {
+    flush();
+    if (!m_staticFbo)
+      glGenFramebuffers(1, &m_staticFbo);
+    if (!m_staticTex || m_staticW != m_W || m_staticH != m_H) {
+      if (!m_staticTex)
+        glGenTextures(1, &m_staticTex);
+      bindTex(1, GL_TEXTURE_2D, m_staticTex);
+      glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_W, m_H, 0, GL_RGBA,
+                   GL_UNSIGNED_BYTE, nullptr);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+      m_staticW = m_W;
+      m_staticH = m_H;
+    }
+    // Never leave the target bound for sampling while drawing into it
+    bindTex(1, GL_TEXTURE_2D, 0);
+    GLint prevFbo;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &prevFbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_staticFbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                           m_staticTex, 0);
+    glClear(GL_COLOR_BUFFER_BIT);
+    // Keep destination alpha at 1 so the layer composites as an opaque copy
+    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE,
+                        GL_ONE_MINUS_SRC_ALPHA);
+
+    m_prof.pass(Profiler::SKY);
+    Opt sky;
+    sky.c = SKY;
+    sky.fx = 4;
+    dR(0, 0, (float)m_W, (float)m_H, sky);
+    m_prof.pass(Profiler::CITY);
+    drawCity();
+
+    // Floor tiles (SVG block)
+    m_prof.pass(Profiler::FLOORS);
+    for (V2 p : state.floorCells)
+      drawTile(p.x, p.y);
+
+    // Trap tiles (SVG), drawn even where a box or the snake covers them
+    m_prof.pass(Profiler::TRAPS);
+    for (V2 p : state.trapCells) {
+      int gx = p.x, gy = p.y;
+      // Base points to nearest floor block.
+      // SVG base is drawn at the bottom (angle 0).
+      float angle = 0.0f;
+      if (state.safeAt(gx, gy + 1) == T::Floor) {
+        angle = 0.0f; // Base down, spikes up
+      } else if (state.safeAt(gx - 1, gy) == T::Floor) {
+        angle = (float)M_PI / 2.0f; // Base left, spikes right (>)
+      } else if (state.safeAt(gx + 1, gy) == T::Floor) {
+        angle = -(float)M_PI / 2.0f; // Base right, spikes left (<)
+      } else if (state.safeAt(gx, gy - 1) == T::Floor) {
+        angle = (float)M_PI; // Base up, spikes down
+      }
+      drawTrap(gx, gy, angle);
+    }
+
+    m_prof.pass(Profiler::SUBMIT);
+    m_prof.beginGpu(Profiler::GPU_STATIC);
+    flush();
+    m_prof.endGpu();
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)prevFbo);
+    m_staticKey = key;
+    m_staticValid = true;
+  }
+
+  Opt layer;
+  layer.fx = FX_STATIC;
+  dR(0, 0, (float)m_W, (float)m_H, layer);
+}
+
 void Renderer::renderFrame(const GameState &state, int currentLevel,
                            int totalLevels, float time) {
+  m_prof.beginFrame();
+  m_lat.poll();
   glClear(GL_COLOR_BUFFER_BIT);
+  layoutBoard(state);
+  m_sheet.update(m_cell);
+  resetState();
 
-  // ── Sky ──────────────────────────────────────────────────────────────────
-  Opt sky;
-  sky.c = SKY;
-  sky.fx = 4;
-  dR(0, 0, (float)m_W, (float)m_H, sky);
-  drawCity();
+  // ── Sky, city, floors and traps ──────────────────────────────────────────
+  drawStatic(state);
 
   // ── HUD ──────────────────────────────────────────────────────────────────
+  m_prof.pass(Profiler::HUD);
   Opt hb;
   hb.c = {0.86f, 0.92f, 0.96f, 0.55f};
   dR(0, 0, (float)m_W, (float)HUD_H, hb);
@@ -716,63 +1144,24 @@ void Renderer::renderFrame(const GameState &state, int currentLevel,
   }
 
   // ── Board ────────────────────────────────────────────────────────────────
-  float availableHeight = m_H - HUD_H - BOT_H;
-
-  // Calculate dynamic cell size to fit the board + 1 cell padding on each side
-  float maxCellW = (float)m_W / (state.w + 2.0f);
-  float maxCellH = availableHeight / (state.h + 2.0f);
-  m_cell = std::min({maxCellW, maxCellH, (float)CELL});
-
-  m_ox = (m_W - state.w * m_cell) / 2;
-  m_oy = HUD_H + (availableHeight - state.h * m_cell) / 2;
-
-  // 1. Floor tiles (SVG block)
-  for (int gy = 0; gy < state.h; gy++)
-    for (int gx = 0; gx < state.w; gx++)
-      if (state.at(gx, gy) == T::Floor)
-        drawTile(gx, gy);
-
-  // 2. Trap tiles (SVG). Draw unconditionally (even if covered by a box or
-  // snake)
-  for (int gy = 0; gy < state.h; gy++) {
-    for (int gx = 0; gx < state.w; gx++) {
-      if (state.at(gx, gy) == T::Trap || state.trapMask[gy * state.w + gx]) {
-        // Base points to nearest floor block.
-        // SVG base is drawn at the bottom (angle 0).
-        float angle = 0.0f;
-        if (state.safeAt(gx, gy + 1) == T::Floor) {
-          angle = 0.0f; // Base down, spikes up
-        } else if (state.safeAt(gx - 1, gy) == T::Floor) {
-          angle = (float)M_PI / 2.0f; // Base left, spikes right (>)
-        } else if (state.safeAt(gx + 1, gy) == T::Floor) {
-          angle = -(float)M_PI / 2.0f; // Base right, spikes left (<)
-        } else if (state.safeAt(gx, gy - 1) == T::Floor) {
-          angle = (float)M_PI; // Base up, spikes down
-        }
-        drawTrap(gx, gy, angle);
-      }
-    }
-  }
-
   // 3. Boxes
-  for (int gy = 0; gy < state.h; gy++)
-    for (int gx = 0; gx < state.w; gx++)
-      if (state.at(gx, gy) == T::Box)
-        drawBox(gx, gy);
+  m_prof.pass(Profiler::BOXES);
+  for (V2 p : state.boxCells)
+    drawBox(p.x, p.y);
 
   // 4. Portal / vortex (SVG, clockwise)
-  for (int gy = 0; gy < state.h; gy++)
-    for (int gx = 0; gx < state.w; gx++)
-      if (state.at(gx, gy) == T::Portal)
-        drawPortal(gx, gy, time);
+  m_prof.pass(Profiler::PORTALS);
+  for (V2 p : state.portalCells)
+    if (state.at(p.x, p.y) == T::Portal) // not covered
+      drawPortal(p.x, p.y, time);
 
   // 5. Apples (SVG)
-  for (int gy = 0; gy < state.h; gy++)
-    for (int gx = 0; gx < state.w; gx++)
-      if (state.at(gx, gy) == T::Apple)
-        drawApple(gx, gy, time);
+  m_prof.pass(Profiler::APPLES);
+  for (V2 p : state.appleCells)
+    drawApple(p.x, p.y, time);
 
   // 6. Snake (back-to-front: tail first, head last)
+  m_prof.pass(Profiler::SNAKE);
   int sLen = (int)state.snake.size();
   int pLen = (int)state.prevSnake.size();
 
@@ -857,6 +1246,7 @@ void Renderer::renderFrame(const GameState &state, int currentLevel,
   }
 
   // ── Footer ───────────────────────────────────────────────────────────────
+  m_prof.pass(Profiler::OVERLAYS);
   Opt bb;
   bb.c = {0.86f, 0.92f, 0.96f, 0.55f};
   dR(0, (float)(m_H - BOT_H), (float)m_W, (float)BOT_H, bb);
@@ -873,7 +1263,7 @@ void Renderer::renderFrame(const GameState &state, int currentLevel,
 
   // ── Death Overlay ─────────────────────────────────────────────────────────
   if (state.dead) {
-    float alp = std::min(1.f, state.deadTimer * 2.5f);
+    float alp = std::min(1.f, state.deadTimer * FADE_RATE);
     Opt ov;
     ov.c = {0.f, 0.f, 0.f, 0.55f * alp};
     dR(0, 0, (float)m_W, (float)m_H, ov);
@@ -927,7 +1317,7 @@ void Renderer::renderFrame(const GameState &state, int currentLevel,
 
   // ── Win Overlay ──────────────────────────────────────────────────────────
   if (state.won) {
-    float alp = std::min(1.f, state.winTimer * 2.5f);
+    float alp = std::min(1.f, state.winTimer * FADE_RATE);
     Opt ov;
     ov.c = {0.f, 0.f, 0.f, 0.62f * alp};
     dR(0, 0, (float)m_W, (float)m_H, ov);
@@ -996,4 +1386,15 @@ void Renderer::renderFrame(const GameState &state, int currentLevel,
       dStr(fin, (m_W - tw) * .5f, ppy + ph - 26, sc, {0.98f, 0.80f, 0.18f, 1});
     }
   }
+
+  m_prof.pass(Profiler::NONE);
+  if (m_prof.on())
+    drawProfiler();
+  if (m_lat.on())
+    drawLatency();
+
+  m_prof.pass(Profiler::SUBMIT);
+  m_prof.beginGpu(Profiler::GPU_BATCH);
+  flush();
+  m_prof.endFrame();
 }
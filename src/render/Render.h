@@ -1,8 +1,12 @@
 #pragma once
 #include "../core/Core.h"
+#include "Latency.h"
+#include "Profiler.h"
+#include "SpriteSheet.h"
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
+#include <vector>
 
 // Encapsulates all OpenGL rendering state and logic
 class Renderer {
@@ -21,23 +25,77 @@ public:
   // Window resize callback
   void resize(int w, int h);
 
+  // What a scene needs redrawn while its state stays the same: FULL while
+  // something moves with the state (a move or fall, an overlay fading in)
+  // or a debug overlay is up, AMBIENT when only the looping portal and
+  // apple animations are on screen, NONE when a redraw would be identical
+  enum class Motion { NONE, AMBIENT, FULL };
+  Motion motion(const GameState &state) const;
+
+  // Shows or hides the frame profiler overlay; timings are only taken while
+  // it is shown
+  void toggleProfiler();
+  // Writes the profiler's frame history as CSV. False on I/O failure.
+  bool dumpProfile(const char *path) const;
+
+  // Shows or hides input latency stats; while shown, every traced input is
+  // logged to logPath. False if the log cannot be opened.
+  bool toggleLatency(const char *logPath);
+  // Call right after each swap with the arrival times of the inputs whose
+  // results the frame showed first
+  void presented(const std::vector<LatencyTracer::Clock::time_point> &inputs);
+
 private:
+  // Sprites, one layer each of m_sheet
+  enum Spr {
+    SPR_APPLE,
+    SPR_BLOCK,
+    SPR_TRAP,
+    SPR_PORTAL,
+    SPR_HEAD,
+    SPR_MID,
+    SPR_TAIL,
+    SPR_COUNT
+  };
+  // Opt::fx values past the shader effects 0-6: a glyph of the HUD font
+  // (Opt::spr is the glyph) and the cached static layer
+  static constexpr int FX_GLYPH = 7, FX_STATIC = 8, NUM_FX = 9;
+
   struct Opt {
     glm::vec4 c = {1, 1, 1, 1};
     float r = 0, t = 0;
     int fx = 0;
-    GLuint tex = 0;
+    int spr = -1; // Spr to sample, -1 for a flat quad (the glyph index
+                  // for FX_GLYPH quads)
   };
 
+  // One quad of the sprite batch. The unit quad is mapped to pixels by the
+  // column-major 2x2 xf and then moved by off.
+  struct Inst {
+    float xf[4];
+    float off[2];
+    float c[4];
+    float r, t;
+    float pad;   // unused: FX is fixed per pipeline; keeps r..layer a vec4
+    float layer; // sprite layer, or the sheet's white layer for flat quads
+  };
+
+  // Queues a quad; everything queued is drawn in order by flush()
+  void push(const Inst &q, const Opt &o);
+  void flush();
+
   void dR(float px, float py, float w, float h, const Opt &o);
   // Draw rect centered at (cx,cy) with given size and rotation angle in radians
   void dRot(float cx, float cy, float w, float h, float angle, const Opt &o);
   void dC(int gx, int gy, float sz, const Opt &o);
 
+  void buildFont();
   void dCh(char c, float px, float py, float sc, glm::vec4 col);
   float dStr(const char *s, float px, float py, float sc, glm::vec4 col);
   float strW(const char *s, float sc);
 
+  void layoutBoard(const GameState &state);
+  void drawStatic(const GameState &state);
   void drawCity();
   void drawTile(int gx, int gy);
   void drawApple(int gx, int gy, float t);
@@ -50,22 +108,67 @@ private:
   void drawButton(float px, float py, float w, float h, glm::vec4 bg,
                   const char *label, glm::vec4 tc, float sc);
 
-  GLuint m_prog;
+  // Shader variants, linked on first use: one per fx and per textured/flat,
+  // so the fragment shader never branches on either
+  struct Pipeline {
+    GLuint prog = 0;
+    GLint lProj = -1;
+    uint32_t projGen = 0; // m_projGen last uploaded to uProj
+  };
+  Pipeline &pipeline(int fx, bool textured);
+  Pipeline m_pipes[NUM_FX][2];
+  GLuint m_vs; // shared by every pipeline
+
+  // GL state last set through useProgram/bindTex, to skip redundant calls
+  void useProgram(Pipeline &p);
+  void bindTex(int unit, GLenum target, GLuint tex);
+  void resetState();
+  GLuint m_curProg;
+  GLuint m_curTex[3]; // per texture unit
+
   GLuint m_vao, m_vbo, m_ebo;
-  GLint m_lMVP, m_lCol, m_lRnd, m_lTime, m_lFx;
-  GLint m_lUseTex;
+  GLuint m_instVbo;
+  GLsizeiptr m_instCap; // bytes allocated for m_instVbo
   glm::mat4 m_proj;
+  uint32_t m_projGen; // bumped whenever m_proj changes
+
+  // Consecutive instances drawn by one pipeline
+  struct Run {
+    int fx;
+    bool textured;
+    int first, count;
+  };
+  std::vector<Inst> m_batch;
+  std::vector<Run> m_runs;
+
+  // All sprites share one array texture, so the batch never rebinds
+  SpriteSheet m_sheet;
+  bool hasSpr(int s) const { return m_sheet.has(s); }
+
+  // The static layer (sky, city, floors, traps) is drawn into m_staticTex
+  // once and composited as one quad until something it depends on changes
+  struct StaticKey {
+    uint32_t layoutGen;
+    int W, H, w, h;
+    GLuint sprites;
+    bool operator==(const StaticKey &o) const {
+      return layoutGen == o.layoutGen && W == o.W && H == o.H && w == o.w &&
+             h == o.h && sprites == o.sprites;
+    }
+  };
+  GLuint m_staticFbo, m_staticTex;
+  int m_staticW, m_staticH; // size of m_staticTex
+  StaticKey m_staticKey;
+  bool m_staticValid;
+
+  // Distance fields of the HUD font, one glyph per layer (see buildFont)
+  GLuint m_fontTex;
 
-  // Textures
-  GLuint m_texApple;
-  GLuint m_texBlock;
-  GLuint m_texTrap;
-  GLuint m_texPortal;
-  GLuint m_texSnakeHead;
-  GLuint m_texSnakeMid;
-  GLuint m_texSnakeTail;
+  Profiler m_prof;
+  void drawProfiler();
 
-  GLuint loadSVGTexture(const char *filepath, int texWidth, int texHeight);
+  LatencyTracer m_lat;
+  void drawLatency();
 
   int m_W, m_H;
   int m_ox; // x-offset to center board horizontally
@@ -0,0 +1,130 @@
+#include "SpriteSheet.h"
+#include <algorithm>
+#include <chrono>
+
+static constexpr int MIN_SIZE = 16, MAX_SIZE = 256;
+
+SpriteSheet::~SpriteSheet() {
+  if (m_pending.valid())
+    m_pending.wait();
+  if (m_tex)
+    glDeleteTextures(1, &m_tex);
+}
+
+int SpriteSheet::sizeFor(float cell) {
+  int s = MIN_SIZE;
+  while (s < MAX_SIZE && s < cell)
+    s *= 2;
+  return s;
+}
+
+// Appends the mip chain of a size x size RGBA image to it, down to 1x1. Each
+// texel averages its 2x2 parents weighted by alpha, so transparent texels
+// do not darken the edges of a sprite.
+static void appendMips(std::vector<unsigned char> &rgba, int size) {
+  size_t src = 0;
+  for (int s = size; s > 1; s /= 2) {
+    size_t dst = rgba.size();
+    int h = s / 2;
+    rgba.resize(dst + (size_t)h * h * 4);
+    for (int y = 0; y < h; y++) {
+      for (int x = 0; x < h; x++) {
+        unsigned sum[4] = {};
+        for (int k = 0; k < 4; k++) {
+          const unsigned char *p =
+              &rgba[src + (((2 * y + k / 2) * s) + 2 * x + k % 2) * 4];
+          for (int c = 0; c < 3; c++)
+            sum[c] += p[c] * p[3];
+          sum[3] += p[3];
+        }
+        unsigned char *q = &rgba[dst + ((size_t)y * h + x) * 4];
+        for (int c = 0; c < 3; c++)
+          q[c] = sum[3] ? (unsigned char)((sum[c] + sum[3] / 2) / sum[3]) : 0;
+        q[3] = (unsigned char)((sum[3] + 2) / 4);
+      }
+    }
+    src = dst;
+  }
+}
+
+// Rasterizes jobs and builds their mip chains; safe off the GL thread
+static std::vector<SvgJob> rasterize(std::vector<SvgJob> jobs,
+                                     const std::string &cacheDir) {
+  rasterSVGs(jobs, cacheDir);
+  for (SvgJob &j : jobs)
+    if (!j.rgba.empty())
+      appendMips(j.rgba, j.size);
+  return jobs;
+}
+
+std::vector<SvgJob> SpriteSheet::makeJobs(int size) const {
+  std::vector<SvgJob> jobs(m_paths.size());
+  for (size_t i = 0; i < jobs.size(); i++) {
+    jobs[i].path = m_paths[i];
+    jobs[i].size = size;
+  }
+  return jobs;
+}
+
+void SpriteSheet::init(const std::vector<std::string> &paths, float cell) {
+  m_paths = paths;
+  m_cacheDir = svgCacheDir();
+  int size = sizeFor(cell);
+  upload(rasterize(makeJobs(size), m_cacheDir), size);
+}
+
+void SpriteSheet::update(float cell) {
+  if (m_pending.valid()) {
+    if (m_pending.wait_for(std::chrono::seconds(0)) !=
+        std::future_status::ready)
+      return;
+    upload(m_pending.get(), m_pendingSize);
+  }
+  int size = sizeFor(cell);
+  if (size == m_size)
+    return;
+  // The worker owns copies of its inputs; the sheet is only touched here, on
+  // the GL thread, once the future is ready
+  m_pendingSize = size;
+  m_pending =
+      std::async(std::launch::async, rasterize, makeJobs(size), m_cacheDir);
+}
+
+void SpriteSheet::upload(const std::vector<SvgJob> &jobs, int size) {
+  GLuint tex;
+  glGenTextures(1, &tex);
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, tex);
+  // One layer per sprite, then the white layer
+  GLsizei layers = (GLsizei)jobs.size() + 1;
+  int levels = 0;
+  for (int s = size; s >= 1; s /= 2)
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, levels++, GL_RGBA, s, s, layers, 0,
+                 GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, levels - 1);
+  m_ok.assign(jobs.size(), false);
+  for (size_t i = 0; i < jobs.size(); i++) {
+    if (jobs[i].rgba.empty())
+      continue;
+    m_ok[i] = true;
+    const unsigned char *p = jobs[i].rgba.data();
+    for (int l = 0, s = size; l < levels; l++, s /= 2) {
+      glTexSubImage3D(GL_TEXTURE_2D_ARRAY, l, 0, 0, (GLint)i, s, s, 1,
+                      GL_RGBA, GL_UNSIGNED_BYTE, p);
+      p += (size_t)s * s * 4;
+    }
+  }
+  std::vector<unsigned char> white((size_t)size * size * 4, 255);
+  for (int l = 0, s = size; l < levels; l++, s /= 2)
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, l, 0, 0, layers - 1, s, s, 1,
+                    GL_RGBA, GL_UNSIGNED_BYTE, white.data());
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER,
+                  GL_LINEAR_MIPMAP_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  if (m_tex)
+    glDeleteTextures(1, &m_tex);
+  m_tex = tex;
+  m_size = size;
+}
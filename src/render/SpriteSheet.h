@@ -0,0 +1,56 @@
+#pragma once
+#include "SvgCache.h"
+#include <GL/glew.h>
+#include <future>
+#include <string>
+#include <vector>
+
+// ─── Sprite Sheet ────────────────────────────────────────────────────────────
+// Every sprite SVG rasterized into one layer of a GL_TEXTURE_2D_ARRAY with a
+// full mip chain, built on the CPU next to the rasterizer. The raster size
+// follows the on-screen cell size: when that crosses a power of two, the SVGs
+// are re-rasterized on a background thread (through the raster cache) and
+// swapped in once ready, while the current layers keep drawing. Big boards
+// therefore sample small, mipmapped sprites instead of aliasing a fixed
+// 256x256 raster.
+class SpriteSheet {
+public:
+  SpriteSheet() = default;
+  ~SpriteSheet();
+  SpriteSheet(const SpriteSheet &) = delete;
+  SpriteSheet &operator=(const SpriteSheet &) = delete;
+
+  // Rasterizes the SVGs for a cell of `cell` pixels and uploads them before
+  // returning, so the first frame already has its sprites
+  void init(const std::vector<std::string> &paths, float cell);
+  // Call once per frame with the current cell size: starts a re-raster when
+  // the size needs a new tier and uploads one that has finished
+  void update(float cell);
+
+  GLuint texture() const { return m_tex; }
+  // False if the SVG of layer i failed to load
+  bool has(int i) const { return i >= 0 && i < (int)m_ok.size() && m_ok[i]; }
+  int size() const { return m_size; }
+  // True while a re-raster is under way; update() will swap it in
+  bool pending() const { return m_pending.valid(); }
+  // Layer past the sprites that is opaque white, for untextured quads drawn
+  // by a textured shader
+  int whiteLayer() const { return (int)m_ok.size(); }
+
+  // Texels per side for sprites drawn in a cell of `cell` pixels: the next
+  // power of two, so sprites are only ever minified
+  static int sizeFor(float cell);
+
+private:
+  std::vector<SvgJob> makeJobs(int size) const;
+  void upload(const std::vector<SvgJob> &jobs, int size);
+
+  std::vector<std::string> m_paths;
+  std::string m_cacheDir;
+  GLuint m_tex = 0;
+  int m_size = 0;
+  std::vector<bool> m_ok;
+
+  std::future<std::vector<SvgJob>> m_pending;
+  int m_pendingSize = 0;
+};
@@ -0,0 +1,174 @@
+#include "SvgCache.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <system_error>
+#include <thread>
+
+#define NANOSVG_IMPLEMENTATION
+#include "nanosvg.h"
+#define NANOSVGRAST_IMPLEMENTATION
+#include "nanosvgrast.h"
+
+namespace fs = std::filesystem;
+
+static uint64_t fnv1a(const void *data, size_t n) {
+  const unsigned char *p = (const unsigned char *)data;
+  uint64_t h = 1469598103934665603ull;
+  for (size_t i = 0; i < n; i++)
+    h = (h ^ p[i]) * 1099511628211ull;
+  return h;
+}
+
+static bool readFile(const std::string &path, std::string &out) {
+  FILE *f = fopen(path.c_str(), "rb");
+  if (!f)
+    return false;
+  out.clear();
+  char buf[16384];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+    out.append(buf, n);
+  bool ok = !ferror(f);
+  fclose(f);
+  return ok;
+}
+
+// Cache file of an SVG path at a raster size
+static std::string cachePath(const std::string &dir, const SvgJob &j) {
+  char name[48];
+  snprintf(name, sizeof(name), "%016llx-%d.rgba",
+           (unsigned long long)fnv1a(j.path.data(), j.path.size()), j.size);
+  return (fs::path(dir) / name).string();
+}
+
+static bool readCache(const std::string &file, uint64_t svgHash, SvgJob &j) {
+  FILE *f = fopen(file.c_str(), "rb");
+  if (!f)
+    return false;
+  SvgCacheHeader hdr;
+  size_t bytes = (size_t)j.size * j.size * 4;
+  bool ok = fread(&hdr, sizeof(hdr), 1, f) == 1 &&
+            memcmp(hdr.magic, SVG_CACHE_MAGIC, 4) == 0 &&
+            hdr.version == SVG_CACHE_VERSION && hdr.size == (uint32_t)j.size &&
+            hdr.svgHash == svgHash;
+  if (ok) {
+    j.rgba.resize(bytes);
+    ok = fread(j.rgba.data(), 1, bytes, f) == bytes;
+  }
+  fclose(f);
+  if (!ok)
+    j.rgba.clear();
+  return ok;
+}
+
+// Writes to a temporary name first so a crash never leaves a torn file
+static void writeCache(const std::string &file, uint64_t svgHash,
+                       const SvgJob &j) {
+  SvgCacheHeader hdr;
+  memcpy(hdr.magic, SVG_CACHE_MAGIC, 4);
+  hdr.version = SVG_CACHE_VERSION;
+  hdr.size = (uint32_t)j.size;
+  hdr.reserved = 0;
+  hdr.svgHash = svgHash;
+  std::string tmp = file + ".tmp";
+  FILE *f = fopen(tmp.c_str(), "wb");
+  if (!f)
+    return;
+  bool ok = fwrite(&hdr, sizeof(hdr), 1, f) == 1 &&
+            fwrite(j.rgba.data(), 1, j.rgba.size(), f) == j.rgba.size();
+  ok = fclose(f) == 0 && ok;
+  std::error_code ec;
+  if (ok)
+    fs::rename(tmp, file, ec);
+  if (!ok || ec)
+    fs::remove(tmp, ec);
+}
+
+// nanosvg parses in place, so svg is consumed
+static void rasterize(std::string &svg, SvgJob &j) {
+  NSVGimage *img = nsvgParse(&svg[0], "px", 96.0f);
+  if (!img || img->width <= 0 || img->height <= 0) {
+    nsvgDelete(img);
+    std::cerr << "Failed to load SVG: " << j.path << "\n";
+    return;
+  }
+  NSVGrasterizer *rast = nsvgCreateRasterizer();
+  j.rgba.assign((size_t)j.size * j.size * 4, 0);
+  float scale = std::min(j.size / img->width, j.size / img->height);
+  nsvgRasterize(rast, img, 0, 0, scale, j.rgba.data(), j.size, j.size,
+                j.size * 4);
+  nsvgDeleteRasterizer(rast);
+  nsvgDelete(img);
+}
+
+void rasterSVGs(std::vector<SvgJob> &jobs, const std::string &cacheDir) {
+  bool useCache = !cacheDir.empty();
+  if (useCache) {
+    std::error_code ec;
+    fs::create_directories(cacheDir, ec);
+    useCache = !ec;
+  }
+
+  // Hash every SVG and serve what the cache has
+  int n = (int)jobs.size();
+  std::vector<std::string> svgs(n);
+  std::vector<uint64_t> hashes(n);
+  std::vector<int> misses;
+  for (int i = 0; i < n; i++) {
+    SvgJob &j = jobs[i];
+    j.rgba.clear();
+    j.cached = false;
+    if (!readFile(j.path, svgs[i])) {
+      std::cerr << "Failed to load SVG: " << j.path << "\n";
+      continue;
+    }
+    hashes[i] = fnv1a(svgs[i].data(), svgs[i].size());
+    svgs[i].push_back('\0');
+    if (useCache && readCache(cachePath(cacheDir, j), hashes[i], j))
+      j.cached = true;
+    else
+      misses.push_back(i);
+  }
+
+  // Rasterize the misses across a small pool, one job at a time each
+  std::atomic<int> next{0};
+  auto worker = [&]() {
+    for (int k; (k = next.fetch_add(1)) < (int)misses.size();) {
+      SvgJob &j = jobs[misses[k]];
+      rasterize(svgs[misses[k]], j);
+      if (useCache && !j.rgba.empty())
+        writeCache(cachePath(cacheDir, j), hashes[misses[k]], j);
+    }
+  };
+  int threads = (int)std::max(1u, std::thread::hardware_concurrency());
+  std::vector<std::thread> pool;
+  for (int t = 1; t < std::min(threads, (int)misses.size()); t++)
+    pool.emplace_back(worker);
+  worker();
+  for (auto &t : pool)
+    t.join();
+}
+
+std::string svgCacheDir() {
+  const char *dir = getenv("SNAKE_CACHE_DIR");
+  if (dir)
+    return dir;
+  fs::path base;
+#if defined(_WIN32)
+  if ((dir = getenv("LOCALAPPDATA")) && *dir)
+    base = dir;
+#else
+  if ((dir = getenv("XDG_CACHE_HOME")) && *dir)
+    base = dir;
+  else if ((dir = getenv("HOME")) && *dir)
+    base = fs::path(dir) / ".cache";
+#endif
+  if (base.empty())
+    return "";
+  return (base / "snake_puzzle").string();
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ─── SVG Raster Cache ────────────────────────────────────────────────────────
+// Rasterizing the sprite SVGs dominates a cold start, so their RGBA images are
+// kept on disk. A cache file is named after the SVG path and raster size and
+// stores the hash of the SVG text it was made from; a hit costs reading the
+// SVG and the raw pixels, with no parsing or rasterizing.
+//
+// Cache file layout, native-endian:
+//   SvgCacheHeader
+//   size * size * 4 bytes of RGBA, row-major
+constexpr char SVG_CACHE_MAGIC[4] = {'S', 'N', 'K', 'R'};
+constexpr uint32_t SVG_CACHE_VERSION = 1;
+
+struct SvgCacheHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t size;
+  uint32_t reserved;
+  uint64_t svgHash; // FNV-1a of the SVG file's bytes
+};
+
+// One sprite: an SVG scaled to fit a size x size RGBA image
+struct SvgJob {
+  std::string path;
+  int size = 0;
+  std::vector<unsigned char> rgba; // out: size*size*4 bytes, empty on failure
+  bool cached = false;             // out: read from the cache
+};
+
+// Fills in the pixels of every job. Cache hits are read from cacheDir; the
+// misses are rasterized in parallel across threads and written back. An
+// empty cacheDir turns the cache off.
+void rasterSVGs(std::vector<SvgJob> &jobs, const std::string &cacheDir);
+
+// $SNAKE_CACHE_DIR if set, else the per-user cache directory
+// ($XDG_CACHE_HOME or ~/.cache on POSIX, %LOCALAPPDATA% on Windows) plus
+// "snake_puzzle". "" if none of those is set.
+std::string svgCacheDir();
@@ -0,0 +1,81 @@
+#include "Heuristic.h"
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+
+// Calls f(x, y) for every set cell of b in the level's columns
+template <class F>
+static void forEachCell(const BitLevel &lv, const BitCols &b, F f) {
+  for (int x = 0; x < lv.w; x++)
+    for (uint32_t m = b.c[x]; m; m &= m - 1)
+      f(x, MG - loBit(m));
+}
+
+// Moves the head needs to get from (hx,hy) onto (x,y): one per column
+// crossed and one per row climbed. Dropping is free, gravity does it.
+static int reach(int hx, int hy, int x, int y) {
+  return std::abs(x - hx) + std::max(0, hy - y);
+}
+
+// Uninformed: A* degrades to uniform-cost search
+static int hZero(const BitLevel &, const BitState &) { return 0; }
+
+// Moves to enter the closest portal from (hx,hy). Entering takes at least
+// one move even when the head is right above it.
+static int portalFrom(const BitLevel &lv, int hx, int hy) {
+  int best = INT_MAX;
+  forEachCell(lv, lv.portal, [&](int x, int y) {
+    best = std::min(best, reach(hx, hy, x, y));
+  });
+  return best == INT_MAX ? 0 : std::max(1, best);
+}
+
+// The portal wins whatever is left on the board, so the distance to it
+// alone bounds the moves left.
+static int hPortal(const BitLevel &lv, const BitState &s) {
+  return s.won ? 0 : portalFrom(lv, s.hx, s.hy);
+}
+
+// Greedy tour: nearest apple first, then the next nearest, then the portal.
+// Not admissible, since apples are optional and the nearest-neighbour tour is
+// not the shortest, but it steers the search towards levels' intended
+// routes.
+static int hApples(const BitLevel &lv, const BitState &s) {
+  if (s.won)
+    return 0;
+  V2 left[MG * MG];
+  int n = 0;
+  forEachCell(lv, s.apple, [&](int x, int y) { left[n++] = {x, y}; });
+  int hx = s.hx, hy = s.hy, total = 0;
+  while (n > 0) {
+    int bi = 0;
+    for (int i = 1; i < n; i++)
+      if (reach(hx, hy, left[i].x, left[i].y) <
+          reach(hx, hy, left[bi].x, left[bi].y))
+        bi = i;
+    total += reach(hx, hy, left[bi].x, left[bi].y);
+    hx = left[bi].x;
+    hy = left[bi].y;
+    left[bi] = left[--n];
+  }
+  return total + portalFrom(lv, hx, hy);
+}
+
+static const Heuristic HEURISTICS[] = {
+    {"portal", hPortal, true},
+    {"zero", hZero, true},
+    {"apples", hApples, false},
+};
+
+const Heuristic *solverHeuristics(int &count) {
+  count = (int)(sizeof(HEURISTICS) / sizeof(HEURISTICS[0]));
+  return HEURISTICS;
+}
+
+const Heuristic *findHeuristic(const char *name) {
+  for (const Heuristic &h : HEURISTICS)
+    if (strcmp(h.name, name) == 0)
+      return &h;
+  return nullptr;
+}
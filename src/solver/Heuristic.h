@@ -0,0 +1,20 @@
+#pragma once
+#include "../core/Bits.h"
+
+// ─── Heuristics ──────────────────────────────────────────────────────────────
+// Estimates of the moves left to win from a state, for A* and IDA*. A won
+// state must score 0. Admissible heuristics never overestimate, so the
+// searches using them return shortest solutions; the others trade that for
+// speed and are kept for comparison.
+using HeuristicFn = int (*)(const BitLevel &lv, const BitState &s);
+
+struct Heuristic {
+  const char *name;
+  HeuristicFn eval;
+  bool admissible;
+};
+
+// All built-in heuristics, the default ("portal") first
+const Heuristic *solverHeuristics(int &count);
+// Looks a heuristic up by name; nullptr if unknown
+const Heuristic *findHeuristic(const char *name);
@@ -0,0 +1,539 @@
+#include "Solver.h"
+#include "../game/Levels.h"
+#include "TransTable.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+static const char MOVE_CHARS[4] = {'U', 'R', 'D', 'L'};
+
+// A frontier state and the node it was stored as
+struct Open {
+  BitState s;
+  uint32_t node;
+};
+
+bool solverLoadLevel(int idx, BitLevel &lv, BitState &s) {
+  if (idx < 0 || idx >= getNumLevels())
+    return false;
+  GameState gs;
+  if (!loadLevelData(idx, gs) || gs.w == 0)
+    return false;
+  simLoad(gs, lv, s);
+  return true;
+}
+
+// Node i was reached from node (links[i] >> 2) by move (links[i] & 3); node 0
+// is the start. Walking back from the goal spells the solution in reverse.
+static std::string backtrack(const std::vector<uint32_t> &links,
+                             uint32_t node) {
+  std::string moves;
+  for (; node != 0; node = links[node] >> 2)
+    moves += MOVE_CHARS[links[node] & 3];
+  std::reverse(moves.begin(), moves.end());
+  return moves;
+}
+
+SolveResult solveBfs(const BitLevel &lv, const BitState &start,
+                     const SolveLimits &limits) {
+  using Clock = std::chrono::steady_clock;
+  auto t0 = Clock::now();
+  SolveResult res;
+  SolveStats &st = res.stats;
+
+  TransTable tt;
+  std::vector<uint32_t> links; // parent * 4 + move, per stored node
+  std::vector<Open> cur, next;
+  uint64_t maxNodes = std::min<uint64_t>(limits.maxNodes, 1u << 30);
+
+  auto finish = [&]() {
+    st.nodes = links.size();
+    st.seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+    return res;
+  };
+  auto trackMemory = [&]() {
+    size_t bytes = tt.bytes() + links.capacity() * sizeof(uint32_t) +
+                   (cur.capacity() + next.capacity()) * sizeof(Open);
+    st.peakBytes = std::max(st.peakBytes, bytes);
+  };
+
+  if (start.won) {
+    res.solved = true;
+    return finish();
+  }
+  if (start.dead)
+    return finish();
+
+  tt.insert(start.hash, 0);
+  links.push_back(0);
+  cur.push_back({start, 0});
+
+  while (!cur.empty()) {
+    for (const Open &o : cur) {
+      st.expanded++;
+      for (uint8_t d = 0; d < 4; d++) {
+        BitState n = o.s;
+        if (!simStep(lv, n, DIRS[d]) || n.dead)
+          continue;
+        st.probes++;
+        uint32_t id = (uint32_t)links.size();
+        if (!tt.insert(n.hash, id))
+          continue;
+        links.push_back(o.node * 4 + d);
+        if (n.won) {
+          res.solved = true;
+          res.moves = backtrack(links, id);
+          trackMemory();
+          return finish();
+        }
+        if (links.size() >= maxNodes) {
+          trackMemory();
+          return finish();
+        }
+        next.push_back({n, id});
+      }
+    }
+    trackMemory();
+    cur.swap(next);
+    next.clear();
+  }
+  res.exhausted = true;
+  return finish();
+}
+
+// ─── Parallel BFS ────────────────────────────────────────────────────────────
+// Layer-synchronous: every layer's frontier is cut into chunks of CHUNK
+// states. Each worker owns a range of chunk indices packed into one atomic
+// word; it takes chunks from the front of its own range and, once that is
+// empty, steals the back half of another worker's. No chunks are created
+// during a layer, so a worker that finds every range empty is done with it.
+namespace {
+
+constexpr uint32_t CHUNK = 64;
+
+class ChunkRange {
+public:
+  void set(uint32_t b, uint32_t e) { m_r.store(pack(b, e)); }
+
+  // Owner side: takes the first chunk
+  bool pop(uint32_t &c) {
+    uint64_t v = m_r.load();
+    for (;;) {
+      uint32_t b = (uint32_t)v, e = (uint32_t)(v >> 32);
+      if (b >= e)
+        return false;
+      if (m_r.compare_exchange_weak(v, pack(b + 1, e))) {
+        c = b;
+        return true;
+      }
+    }
+  }
+
+  // Thief side: takes the back half, at least one chunk
+  bool steal(uint32_t &b0, uint32_t &e0) {
+    uint64_t v = m_r.load();
+    for (;;) {
+      uint32_t b = (uint32_t)v, e = (uint32_t)(v >> 32);
+      if (b >= e)
+        return false;
+      uint32_t mid = e - (e - b + 1) / 2;
+      if (m_r.compare_exchange_weak(v, pack(b, mid))) {
+        b0 = mid;
+        e0 = e;
+        return true;
+      }
+    }
+  }
+
+private:
+  static uint64_t pack(uint32_t b, uint32_t e) { return (uint64_t)e << 32 | b; }
+  std::atomic<uint64_t> m_r{0};
+};
+
+struct alignas(64) Worker {
+  ChunkRange range;
+  std::vector<Open> next;
+  uint64_t expanded = 0, probes = 0;
+};
+
+// Runs job(0..n-1) with job(0) on the calling thread; threads persist
+// between layers.
+class WorkerPool {
+public:
+  explicit WorkerPool(int n) {
+    for (int i = 1; i < n; i++)
+      m_threads.emplace_back([this, i] { loop(i); });
+  }
+  ~WorkerPool() {
+    {
+      std::lock_guard<std::mutex> lk(m_mu);
+      m_stop = true;
+    }
+    m_cv.notify_all();
+    for (auto &t : m_threads)
+      t.join();
+  }
+
+  void run(const std::function<void(int)> &job) {
+    {
+      std::lock_guard<std::mutex> lk(m_mu);
+      m_job = &job;
+      m_active = (int)m_threads.size();
+      m_gen++;
+    }
+    m_cv.notify_all();
+    job(0);
+    std::unique_lock<std::mutex> lk(m_mu);
+    m_done.wait(lk, [this] { return m_active == 0; });
+  }
+
+private:
+  void loop(int self) {
+    uint64_t seen = 0;
+    for (;;) {
+      const std::function<void(int)> *job;
+      {
+        std::unique_lock<std::mutex> lk(m_mu);
+        m_cv.wait(lk, [&] { return m_stop || m_gen != seen; });
+        if (m_stop)
+          return;
+        seen = m_gen;
+        job = m_job;
+      }
+      (*job)(self);
+      std::lock_guard<std::mutex> lk(m_mu);
+      if (--m_active == 0)
+        m_done.notify_one();
+    }
+  }
+
+  std::vector<std::thread> m_threads;
+  std::mutex m_mu;
+  std::condition_variable m_cv, m_done;
+  const std::function<void(int)> *m_job = nullptr;
+  uint64_t m_gen = 0;
+  int m_active = 0;
+  bool m_stop = false;
+};
+
+} // namespace
+
+SolveResult solveBfsParallel(const BitLevel &lv, const BitState &start,
+                             int threads, const SolveLimits &limits) {
+  using Clock = std::chrono::steady_clock;
+  auto t0 = Clock::now();
+  SolveResult res;
+  SolveStats &st = res.stats;
+  if (threads <= 0)
+    threads = (int)std::max(1u, std::thread::hardware_concurrency());
+  st.threads = threads;
+
+  static constexpr uint32_t NO_GOAL = ~0u;
+  AtomicKeySet keys;
+  std::vector<uint32_t> links; // parent * 4 + move, per stored node
+  std::vector<Open> cur;
+  std::vector<Worker> workers(threads);
+  std::atomic<uint32_t> nodeCount{0}, goal{NO_GOAL};
+  uint64_t maxNodes = std::min<uint64_t>(limits.maxNodes, 1u << 30);
+
+  auto finish = [&]() {
+    st.nodes = nodeCount;
+    for (const Worker &w : workers) {
+      st.expanded += w.expanded;
+      st.probes += w.probes;
+    }
+    st.seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+    return res;
+  };
+  auto trackMemory = [&]() {
+    size_t bytes = keys.bytes() + links.capacity() * sizeof(uint32_t) +
+                   cur.capacity() * sizeof(Open);
+    for (const Worker &w : workers)
+      bytes += w.next.capacity() * sizeof(Open);
+    st.peakBytes = std::max(st.peakBytes, bytes);
+  };
+
+  if (start.won) {
+    res.solved = true;
+    return finish();
+  }
+  if (start.dead)
+    return finish();
+
+  keys.insert(start.hash);
+  links.push_back(0);
+  nodeCount = 1;
+  cur.push_back({start, 0});
+
+  auto expand = [&](Worker &me, const Open &o) {
+    me.expanded++;
+    for (uint8_t d = 0; d < 4; d++) {
+      BitState n = o.s;
+      if (!simStep(lv, n, DIRS[d]) || n.dead)
+        continue;
+      me.probes++;
+      if (!keys.insert(n.hash))
+        continue;
+      uint32_t id = nodeCount.fetch_add(1);
+      links[id] = o.node * 4 + d;
+      if (n.won) {
+        uint32_t none = NO_GOAL;
+        goal.compare_exchange_strong(none, id);
+        return;
+      }
+      me.next.push_back({n, id});
+    }
+  };
+  std::function<void(int)> layer = [&](int self) {
+    Worker &me = workers[self];
+    uint32_t c, b, e;
+    for (;;) {
+      bool got = me.range.pop(c);
+      for (int k = 1; !got && k < threads; k++) {
+        if (workers[(self + k) % threads].range.steal(b, e)) {
+          me.range.set(b + 1, e);
+          c = b;
+          got = true;
+        }
+      }
+      if (!got || goal != NO_GOAL)
+        return;
+      size_t end = std::min(cur.size(), (size_t)(c + 1) * CHUNK);
+      for (size_t i = (size_t)c * CHUNK; i < end; i++)
+        expand(me, cur[i]);
+    }
+  };
+
+  WorkerPool pool(threads);
+  while (!cur.empty()) {
+    // Every state adds at most four nodes; make room before workers start
+    uint64_t bound = nodeCount + cur.size() * 4;
+    if (nodeCount >= maxNodes || bound > (1u << 30)) {
+      trackMemory();
+      return finish();
+    }
+    keys.reserve(cur.size() * 4);
+    links.resize(bound);
+
+    uint32_t chunks = (uint32_t)((cur.size() + CHUNK - 1) / CHUNK);
+    for (int i = 0; i < threads; i++)
+      workers[i].range.set((uint32_t)((uint64_t)chunks * i / threads),
+                           (uint32_t)((uint64_t)chunks * (i + 1) / threads));
+    pool.run(layer);
+    trackMemory();
+
+    if (goal != NO_GOAL) {
+      links.resize(nodeCount);
+      res.solved = true;
+      res.moves = backtrack(links, goal);
+      return finish();
+    }
+    cur.clear();
+    for (Worker &w : workers) {
+      cur.insert(cur.end(), w.next.begin(), w.next.end());
+      w.next.clear();
+    }
+  }
+  res.exhausted = true;
+  return finish();
+}
+
+// ─── A* ──────────────────────────────────────────────────────────────────────
+// Best-first on f = g + h with ties going to the deeper node. Goals are
+// tested when popped, so with an admissible heuristic the first win is a
+// shortest one. A node reached again more cheaply is queued again; with a
+// consistent heuristic such as "portal" that never happens.
+SolveResult solveAStar(const BitLevel &lv, const BitState &start,
+                       const Heuristic &h, const SolveLimits &limits) {
+  using Clock = std::chrono::steady_clock;
+  auto t0 = Clock::now();
+  SolveResult res;
+  SolveStats &st = res.stats;
+
+  struct Entry {
+    int f, g;
+    uint32_t node;
+    bool operator<(const Entry &o) const {
+      return f != o.f ? f > o.f : g < o.g; // max-heap → smallest f first
+    }
+  };
+  TransTable tt;
+  std::vector<uint32_t> links; // parent * 4 + move, per stored node
+  std::vector<int> gs;         // best known depth, per node
+  std::vector<BitState> states;
+  std::vector<Entry> open;
+  uint64_t maxNodes = std::min<uint64_t>(limits.maxNodes, 1u << 30);
+
+  auto finish = [&]() {
+    st.nodes = links.size();
+    st.seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+    st.peakBytes = tt.bytes() +
+                   links.capacity() * (sizeof(uint32_t) + sizeof(int)) +
+                   states.capacity() * sizeof(BitState) +
+                   open.capacity() * sizeof(Entry);
+    return res;
+  };
+
+  if (start.dead)
+    return finish();
+  tt.insert(start.hash, 0);
+  links.push_back(0);
+  gs.push_back(0);
+  states.push_back(start);
+  open.push_back({h.eval(lv, start), 0, 0});
+
+  while (!open.empty()) {
+    std::pop_heap(open.begin(), open.end());
+    Entry e = open.back();
+    open.pop_back();
+    if (e.g != gs[e.node])
+      continue; // superseded by a cheaper path
+    if (states[e.node].won) {
+      res.solved = true;
+      res.moves = backtrack(links, e.node);
+      return finish();
+    }
+    st.expanded++;
+    for (uint8_t d = 0; d < 4; d++) {
+      BitState n = states[e.node];
+      if (!simStep(lv, n, DIRS[d]) || n.dead)
+        continue;
+      st.probes++;
+      uint32_t id = (uint32_t)links.size(), old;
+      int g = e.g + 1;
+      if (tt.insert(n.hash, id, &old)) {
+        if (links.size() >= maxNodes)
+          return finish();
+        links.push_back(e.node * 4 + d);
+        gs.push_back(g);
+        states.push_back(n);
+      } else if (g < gs[old]) {
+        id = old;
+        links[id] = e.node * 4 + d;
+        gs[id] = g;
+      } else {
+        continue;
+      }
+      open.push_back({g + h.eval(lv, n), g, id});
+      std::push_heap(open.begin(), open.end());
+    }
+  }
+  res.exhausted = true;
+  return finish();
+}
+
+// ─── IDA* ────────────────────────────────────────────────────────────────────
+// Depth-first passes bounded by f = g + h, raising the bound to the smallest
+// f that exceeded it. Memory is one state per level of the current path
+// plus an optional fixed-size table (limits.idaTableBits): a state already
+// searched this pass at the same or a smaller depth is skipped, since that
+// search had at least as much of the bound left. The table is direct-mapped
+// and overwrites on collision, so it only ever costs re-searching.
+namespace {
+
+struct IdaSearch {
+  struct Seen {
+    uint64_t key;
+    int32_t g, pass;
+  };
+
+  const BitLevel &lv;
+  const Heuristic &h;
+  SolveStats &st;
+  uint64_t maxNodes;
+  std::vector<Seen> seen;     // empty: no table, memory stays O(depth)
+  std::vector<uint64_t> path; // keys of the states on the current path
+  std::string moves;
+  int pass = 0;
+  bool aborted = false;
+
+  // True if s was searched this pass from depth g or shallower
+  bool searched(const BitState &s, int g) {
+    if (seen.empty())
+      return false;
+    Seen &e = seen[s.hash & (seen.size() - 1)];
+    if (e.pass == pass && e.key == s.hash && e.g <= g)
+      return true;
+    e = {s.hash, g, pass};
+    return false;
+  }
+
+  static constexpr int FOUND = -1;
+  static constexpr int NONE = INT_MAX;
+
+  // Returns FOUND, or the smallest f above bound seen below s
+  int dfs(const BitState &s, int g, int bound) {
+    int f = g + h.eval(lv, s);
+    if (f > bound)
+      return f;
+    if (s.won)
+      return FOUND;
+    if (searched(s, g))
+      return NONE;
+    if (++st.expanded > maxNodes) {
+      aborted = true;
+      return NONE;
+    }
+    int next = NONE;
+    path.push_back(s.hash);
+    for (uint8_t d = 0; d < 4 && !aborted; d++) {
+      BitState n = s;
+      if (!simStep(lv, n, DIRS[d]) || n.dead)
+        continue;
+      st.probes++;
+      if (std::find(path.begin(), path.end(), n.hash) != path.end())
+        continue;
+      moves.push_back(MOVE_CHARS[d]);
+      int t = dfs(n, g + 1, bound);
+      if (t == FOUND)
+        return FOUND;
+      moves.pop_back();
+      next = std::min(next, t);
+    }
+    path.pop_back();
+    return next;
+  }
+};
+
+} // namespace
+
+SolveResult solveIdaStar(const BitLevel &lv, const BitState &start,
+                         const Heuristic &h, const SolveLimits &limits) {
+  using Clock = std::chrono::steady_clock;
+  auto t0 = Clock::now();
+  SolveResult res;
+  SolveStats &st = res.stats;
+  IdaSearch ida{lv, h, st, limits.maxNodes, {}, {}, {}};
+  if (limits.idaTableBits > 0)
+    ida.seen.assign((size_t)1 << limits.idaTableBits, {0, 0, -1});
+
+  if (!start.dead) {
+    for (int bound = h.eval(lv, start);; ida.pass++) {
+      int t = ida.dfs(start, 0, bound);
+      if (t == IdaSearch::FOUND) {
+        res.solved = true;
+        res.moves = ida.moves;
+        break;
+      }
+      if (ida.aborted)
+        break;
+      if (t == IdaSearch::NONE) {
+        res.exhausted = true;
+        break;
+      }
+      bound = t;
+    }
+  }
+  st.nodes = st.expanded;
+  st.seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+  st.peakBytes = ida.path.capacity() * (sizeof(uint64_t) + sizeof(BitState)) +
+                 ida.moves.capacity() +
+                 ida.seen.capacity() * sizeof(IdaSearch::Seen);
+  return res;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include "../game/Sim.h"
+#include "Heuristic.h"
+#include <cstdint>
+#include <string>
+
+// ─── Solver ──────────────────────────────────────────────────────────────────
+// Searches the rule kernel (simStep) for the shortest winning move sequence.
+// Moves are reported as a string of U/D/L/R, the format snake_headless reads.
+
+struct SolveLimits {
+  uint64_t maxNodes = 20000000; // give up after this many distinct states
+  int idaTableBits = 20; // IDA* revisit table size (log2); 0 turns it off
+};
+
+struct SolveStats {
+  uint64_t nodes = 0;    // distinct states stored
+  uint64_t expanded = 0; // states whose moves were generated
+  uint64_t probes = 0;   // transposition table lookups
+  double seconds = 0;
+  int threads = 1;
+  size_t peakBytes = 0; // table + node array + frontier at their largest
+
+  double nodesPerSec() const { return seconds > 0 ? nodes / seconds : 0; }
+};
+
+struct SolveResult {
+  bool solved = false;
+  bool exhausted = false; // every reachable state was visited: no solution
+  std::string moves;
+  SolveStats stats;
+};
+
+// Breadth-first search: the first win found uses the fewest moves.
+SolveResult solveBfs(const BitLevel &lv, const BitState &start,
+                     const SolveLimits &limits = SolveLimits());
+
+// Breadth-first search on `threads` worker threads (0: one per core) with
+// work-stealing over frontier chunks and a lock-free visited set. Finds a
+// solution of the same length as solveBfs, not necessarily the same moves.
+SolveResult solveBfsParallel(const BitLevel &lv, const BitState &start,
+                             int threads,
+                             const SolveLimits &limits = SolveLimits());
+
+// A* guided by h. Shortest solutions when h is admissible; keeps every
+// visited state, like solveBfs, but visits far fewer of them.
+SolveResult solveAStar(const BitLevel &lv, const BitState &start,
+                       const Heuristic &h,
+                       const SolveLimits &limits = SolveLimits());
+
+// Iterative-deepening A*: memory is the current path plus a fixed-size
+// table of searched states (limits.idaTableBits), so it does not grow with
+// the state space. limits.maxNodes caps expansions.
+SolveResult solveIdaStar(const BitLevel &lv, const BitState &start,
+                         const Heuristic &h,
+                         const SolveLimits &limits = SolveLimits());
+
+// Loads LEVELS[idx] into the kernel layers, as GameEngine::loadLevel does.
+// Returns false if idx is out of range or the level cannot be read (a broken
+// level pack record).
+bool solverLoadLevel(int idx, BitLevel &lv, BitState &s);
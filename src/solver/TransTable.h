@@ -0,0 +1,132 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Open-addressing set of 64-bit state keys (BitState::hash), each mapped to a
+// node index. Only the key is kept, not the state: two states colliding on
+// all 64 bits would be merged, which at the few million states a level
+// produces is far less likely than a hardware fault. Keys and values live in
+// separate arrays (12 bytes per slot); the table doubles when half full.
+class TransTable {
+public:
+  explicit TransTable(size_t capacity = 1 << 12) { reset(capacity); }
+
+  void reset(size_t capacity) {
+    size_t cap = 16;
+    while (cap < capacity)
+      cap <<= 1;
+    m_keys.assign(cap, 0);
+    m_vals.assign(cap, 0);
+    m_size = 0;
+  }
+
+  // Stores key → val unless key is present. Returns true if it was new;
+  // otherwise *found (if given) receives the stored value.
+  bool insert(uint64_t key, uint32_t val, uint32_t *found = nullptr) {
+    if ((m_size + 1) * 2 > m_keys.size())
+      grow();
+    key = key ? key : 1; // 0 marks an empty slot
+    size_t mask = m_keys.size() - 1;
+    for (size_t i = (size_t)key & mask;; i = (i + 1) & mask) {
+      if (m_keys[i] == 0) {
+        m_keys[i] = key;
+        m_vals[i] = val;
+        m_size++;
+        return true;
+      }
+      if (m_keys[i] == key) {
+        if (found)
+          *found = m_vals[i];
+        return false;
+      }
+    }
+  }
+
+  size_t size() const { return m_size; }
+  size_t bytes() const {
+    return m_keys.capacity() * sizeof(uint64_t) +
+           m_vals.capacity() * sizeof(uint32_t);
+  }
+
+private:
+  void grow() {
+    std::vector<uint64_t> keys;
+    std::vector<uint32_t> vals;
+    keys.swap(m_keys);
+    vals.swap(m_vals);
+    reset(keys.size() * 2);
+    for (size_t i = 0; i < keys.size(); i++)
+      if (keys[i])
+        insert(keys[i], vals[i]);
+  }
+
+  std::vector<uint64_t> m_keys;
+  std::vector<uint32_t> m_vals;
+  size_t m_size = 0;
+};
+
+// Lock-free set of 64-bit keys for the parallel solver. insert() may be
+// called from any number of threads; a slot is claimed with one CAS and keys
+// are never removed, so a probe sequence only ever sees slots fill up. The
+// table does not grow while threads insert: reserve() between search layers,
+// with no inserts in flight, for every key the next layer can add.
+class AtomicKeySet {
+public:
+  explicit AtomicKeySet(size_t capacity = 1 << 12) { rehash(capacity); }
+
+  // Returns true if key was not present and this call added it
+  bool insert(uint64_t key) {
+    key = key ? key : 1; // 0 marks an empty slot
+    size_t mask = m_cap - 1;
+    for (size_t i = (size_t)key & mask;; i = (i + 1) & mask) {
+      uint64_t cur = m_keys[i].load(std::memory_order_relaxed);
+      if (cur == key)
+        return false;
+      if (cur == 0) {
+        if (m_keys[i].compare_exchange_strong(cur, key,
+                                              std::memory_order_relaxed)) {
+          m_size.fetch_add(1, std::memory_order_relaxed);
+          return true;
+        }
+        if (cur == key)
+          return false; // another thread added the same key first
+      }
+    }
+  }
+
+  // Makes room for `more` keys at under half load. Not thread-safe.
+  void reserve(size_t more) {
+    size_t need = (size() + more) * 2;
+    if (need > m_cap)
+      rehash(need);
+  }
+
+  size_t size() const { return m_size.load(std::memory_order_relaxed); }
+  size_t bytes() const { return m_cap * sizeof(uint64_t); }
+
+private:
+  void rehash(size_t capacity) {
+    size_t cap = 16;
+    while (cap < capacity)
+      cap <<= 1;
+    std::unique_ptr<std::atomic<uint64_t>[]> old(std::move(m_keys));
+    size_t oldCap = m_cap;
+    m_keys.reset(new std::atomic<uint64_t>[cap]);
+    m_cap = cap;
+    m_size = 0;
+    for (size_t i = 0; i < cap; i++)
+      m_keys[i].store(0, std::memory_order_relaxed);
+    for (size_t i = 0; i < oldCap; i++) {
+      uint64_t k = old[i].load(std::memory_order_relaxed);
+      if (k)
+        insert(k);
+    }
+  }
+
+  std::unique_ptr<std::atomic<uint64_t>[]> m_keys;
+  size_t m_cap = 0;
+  std::atomic<size_t> m_size{0};
+};
@@ -0,0 +1,354 @@
+// snake_bench — micro-benchmarks for the simulation core.
+//
+// Usage: snake_bench [--samples N] [--filter text] [--csv]
+//   --samples  timed batches per benchmark (default 200)
+//   --filter   only run benchmarks whose name contains text
+//   --csv      machine-readable output
+//
+// Every benchmark runs a fixed, seeded workload: untimed setup, then a timed
+// batch of ops. A batch's time divided by its op count is one sample; the
+// report gives the median, p90, p99 and minimum over all samples in ns/op.
+// Built-in levels are driven through GameEngine, the synthetic 24x24 boards
+// through the rule kernel and MoveLog that GameEngine is built on.
+#include "game/Game.h"
+#include "game/Levels.h"
+#include "game/MoveLog.h"
+#include "game/Sim.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+static int g_samples = 200;
+static const char *g_filter = "";
+static bool g_csv = false;
+
+// Keeps results alive so the optimizer cannot drop the work
+static volatile uint64_t g_sink;
+
+// ─── Harness ─────────────────────────────────────────────────────────────────
+// Runs setup() untimed and body() timed, `ops` operations per batch
+template <class Setup, class Body>
+static void bench(const std::string &name, int ops, Setup setup, Body body) {
+  if (ops <= 0 || !strstr(name.c_str(), g_filter))
+    return;
+  using Clock = std::chrono::steady_clock;
+  for (int i = 0; i < 10; i++) { // warm caches and branch predictors
+    setup();
+    body();
+  }
+  std::vector<double> ns(g_samples);
+  for (double &v : ns) {
+    setup();
+    auto t0 = Clock::now();
+    body();
+    auto t1 = Clock::now();
+    v = std::chrono::duration<double, std::nano>(t1 - t0).count() / ops;
+  }
+  std::sort(ns.begin(), ns.end());
+  auto pct = [&](double p) { return ns[(size_t)(p * (ns.size() - 1))]; };
+  if (g_csv)
+    printf("%s,%d,%.1f,%.1f,%.1f,%.1f\n", name.c_str(), ops, pct(0.5),
+           pct(0.9), pct(0.99), ns[0]);
+  else
+    printf("%-34s %6d %10.1f %10.1f %10.1f %10.1f\n", name.c_str(), ops,
+           pct(0.5), pct(0.9), pct(0.99), ns[0]);
+}
+
+// ─── Workloads ───────────────────────────────────────────────────────────────
+// A seeded random walk that only takes moves leaving the snake alive and the
+// level unfinished, up to maxLen moves
+static std::vector<uint8_t> walk(const BitLevel &lv, BitState s, int maxLen,
+                                 unsigned seed) {
+  std::mt19937 rng(seed);
+  std::vector<uint8_t> moves;
+  while ((int)moves.size() < maxLen) {
+    uint8_t order[4] = {0, 1, 2, 3};
+    std::shuffle(order, order + 4, rng);
+    bool moved = false;
+    for (uint8_t d : order) {
+      BitState n = s;
+      if (simStep(lv, n, DIRS[d]) && !n.dead && !n.won) {
+        s = n;
+        moves.push_back(d);
+        moved = true;
+        break;
+      }
+    }
+    if (!moved)
+      break;
+  }
+  return moves;
+}
+
+// Random MG x MG board with a floor row at the bottom and a snake of `len`
+// cells lying along row 1
+static void syntheticBoard(unsigned seed, int len, GameState &g) {
+  std::mt19937 rng(seed);
+  g = GameState();
+  g.w = g.h = MG;
+  g.grid.assign(MG * MG, T::Void);
+  g.trapMask.assign(MG * MG, false);
+  for (int y = 0; y < MG; y++) {
+    for (int x = 0; x < MG; x++) {
+      int r = (int)(rng() % 100);
+      T t = (y == MG - 1 || r < 12) ? T::Floor
+            : r < 16                ? T::Box
+            : r < 19                ? T::Apple
+            : r < 20                ? T::Trap
+                                    : T::Void;
+      g.at(x, y) = t;
+      if (t == T::Trap)
+        g.trapMask[y * MG + x] = true;
+      if (t == T::Apple)
+        g.apples++;
+    }
+  }
+  g.at(MG - 2, MG - 2) = T::Portal;
+  for (int i = 0; i < len; i++) {
+    g.at(len - i, 1) = T::Void;
+    g.snake.push_back({len - i, 1});
+  }
+}
+
+// Board for deep falls: a snake of `len` cells (at most MG) along the top
+// row and box stacks hanging over an empty board with only the bottom row as
+// floor
+static void fallBoard(int len, GameState &g) {
+  len = std::min(len, MG);
+  g = GameState();
+  g.w = g.h = MG;
+  g.grid.assign(MG * MG, T::Void);
+  g.trapMask.assign(MG * MG, false);
+  for (int x = 0; x < MG; x++)
+    g.at(x, MG - 1) = T::Floor;
+  for (int x = 1; x < MG; x += 3)
+    for (int y = 2; y < 2 + x % 7; y++)
+      g.at(x, y) = T::Box;
+  for (int i = 0; i < len; i++)
+    g.snake.push_back({len - 1 - i, 0});
+}
+
+// Board for long snakes: a snake of `len` cells (a multiple of MG, at most
+// 20 * MG) coiled up and down the columns on a floor row, head at the top of
+// the last column. coilMoves() crawls the head over the coil row by row.
+static void coilBoard(int len, GameState &g) {
+  g = GameState();
+  g.w = g.h = MG;
+  g.grid.assign(MG * MG, T::Void);
+  g.trapMask.assign(MG * MG, false);
+  for (int x = 0; x < MG; x++)
+    g.at(x, MG - 1) = T::Floor;
+  int rows = len / MG, top = MG - 1 - rows;
+  for (int x = MG - 1; x >= 0; x--)
+    for (int i = 0; i < rows; i++)
+      g.snake.push_back({x, x % 2 ? top + i : MG - 2 - i});
+  V2 h = g.snake[0], n = g.snake.size() > 1 ? g.snake[1] : h;
+  g.lastDir = {h.x - n.x, h.y - n.y};
+}
+
+static std::vector<uint8_t> coilMoves(int n) {
+  std::vector<uint8_t> moves;
+  for (int row = 0; (int)moves.size() < n; row++) {
+    moves.push_back(DIR_UP);
+    for (int i = 0; i < MG - 1; i++)
+      moves.push_back(row % 2 ? DIR_RIGHT : DIR_LEFT);
+  }
+  moves.resize(n);
+  return moves;
+}
+
+// ─── Benchmarks ──────────────────────────────────────────────────────────────
+static void benchLevel(int idx) {
+  std::string tag = "L" + std::to_string(idx + 1);
+  GameEngine engine;
+  engine.loadLevel(idx);
+  BitLevel lv;
+  BitState s;
+  GameState gs;
+  loadLevelData(idx, gs);
+  simLoad(gs, lv, s);
+  std::vector<uint8_t> moves = walk(lv, s, 64, 1234u + idx);
+  int n = (int)moves.size();
+
+  bench("loadLevel/" + tag, 16, [] {}, [&] {
+    for (int i = 0; i < 16; i++)
+      engine.loadLevel(idx);
+  });
+
+  bench(
+      "doMove/" + tag, n, [&] { engine.loadLevel(idx); },
+      [&] {
+        for (uint8_t d : moves)
+          engine.doMove(DIRS[d]);
+      });
+
+  bench(
+      "undo/" + tag, n,
+      [&] {
+        engine.loadLevel(idx);
+        for (uint8_t d : moves)
+          engine.doMove(DIRS[d]);
+      },
+      [&] {
+        for (int i = 0; i < n; i++)
+          engine.undo();
+      });
+  g_sink = engine.getStateKey();
+}
+
+static void benchSynthetic(unsigned seed, int len) {
+  std::string tag = "24x24/s" + std::to_string(seed) + "/len" +
+                    std::to_string(len);
+  GameState gs;
+  syntheticBoard(seed, len, gs);
+  BitLevel lv;
+  BitState start;
+  simLoad(gs, lv, start);
+  std::vector<uint8_t> moves = walk(lv, start, 256, seed);
+  int n = (int)moves.size();
+  BitState s;
+  MoveLog log;
+
+  bench(
+      "simStep/" + tag, n, [&] { s = start; },
+      [&] {
+        for (uint8_t d : moves)
+          simStep(lv, s, DIRS[d]);
+      });
+
+  // The record/undo pair that replaced GameEngine::saveState
+  bench(
+      "log.push/" + tag, n,
+      [&] {
+        s = start;
+        log.clear();
+      },
+      [&] {
+        for (uint8_t d : moves) {
+          BitCols before = s.box;
+          MoveRec rec;
+          simStep(lv, s, DIRS[d], &rec);
+          log.push(rec, before, s.box);
+        }
+      });
+  bench(
+      "log.undo/" + tag, n,
+      [&] {
+        s = start;
+        log.clear();
+        for (uint8_t d : moves) {
+          BitCols before = s.box;
+          MoveRec rec;
+          simStep(lv, s, DIRS[d], &rec);
+          log.push(rec, before, s.box);
+        }
+      },
+      [&] {
+        while (log.undo(s))
+          ;
+      });
+
+  bench("simHash/" + tag, 256, [] {}, [&] {
+    uint64_t h = 0;
+    for (int i = 0; i < 256; i++)
+      h += simHash(start);
+    g_sink = h;
+  });
+
+  // The incremental key update of a box push (the box leaves one cell and
+  // enters the next), next to the full recompute
+  std::vector<V2> boxes;
+  for (int x = 0; x < MG; x++)
+    for (uint32_t b = start.box.c[x]; b; b &= b - 1)
+      boxes.push_back({x, MG - loBit(b)});
+  int nb = (int)boxes.size();
+  bench(
+      "hash.push/" + tag, nb ? 256 : 0, [&] { s = start; },
+      [&] {
+        for (int i = 0; i < 256; i++) {
+          V2 p = boxes[i % nb];
+          s.flipBox(p.x, p.y);
+          s.flipBox(p.x, p.y - 1);
+        }
+        g_sink = s.hash;
+      });
+}
+
+static void benchFalls(int len) {
+  std::string tag = "24x24/len" + std::to_string(len);
+  GameState gs;
+  fallBoard(len, gs);
+  BitLevel lv;
+  BitState start;
+  simLoad(gs, lv, start);
+  static constexpr int BATCH = 32;
+  std::vector<BitState> states(BATCH);
+
+  bench(
+      "simGravity/deep/" + tag, BATCH,
+      [&] { std::fill(states.begin(), states.end(), start); },
+      [&] {
+        for (BitState &s : states)
+          simGravity(lv, s);
+      });
+  g_sink = states[0].hash;
+}
+
+// Moves of a long snake that neither eats nor falls (the coil keeps
+// columns on the floor for 64 moves from 4 rows up), so the per-op cost
+// should not depend on len
+static void benchCoil(int len) {
+  std::string tag = "24x24/len" + std::to_string(len);
+  GameState gs;
+  coilBoard(len, gs);
+  BitLevel lv;
+  BitState start;
+  simLoad(gs, lv, start);
+  std::vector<uint8_t> moves = coilMoves(64);
+  BitState s;
+
+  bench(
+      "simStep/coil/" + tag, (int)moves.size(), [&] { s = start; },
+      [&] {
+        for (uint8_t d : moves)
+          simStep(lv, s, DIRS[d]);
+      });
+  g_sink = s.hash;
+}
+
+int main(int argc, char **argv) {
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc) {
+      g_samples = std::max(1, atoi(argv[++i]));
+    } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+      g_filter = argv[++i];
+    } else if (strcmp(argv[i], "--csv") == 0) {
+      g_csv = true;
+    } else {
+      fprintf(stderr, "usage: %s [--samples N] [--filter text] [--csv]\n",
+              argv[0]);
+      return 2;
+    }
+  }
+
+  if (g_csv)
+    printf("benchmark,ops,p50_ns,p90_ns,p99_ns,min_ns\n");
+  else
+    printf("%-34s %6s %10s %10s %10s %10s\n", "benchmark (ns/op)", "ops",
+           "p50", "p90", "p99", "min");
+  for (int i = 0; i < getNumLevels(); i++)
+    benchLevel(i);
+  for (unsigned seed = 1; seed <= 3; seed++)
+    benchSynthetic(seed, 8);
+  benchSynthetic(4, 20);
+  benchFalls(6);
+  benchFalls(24);
+  for (int rows : {4, 8, 14, 20})
+    benchCoil(rows * MG);
+  return 0;
+}
@@ -0,0 +1,121 @@
+// snake_headless — runs the simulation core without any graphics.
+//
+// Usage: snake_headless [-p pack] <level> [moves]
+//   pack   binary level pack to play instead of the built-in levels
+//   level  1-based level number
+//   moves  string of U/D/L/R, Z to undo; case-insensitive
+//
+// Applies the moves in order and prints the resulting board using the level
+// file characters (H/M/B for the snake, '=', 'A', 'P', '#', 'X').
+#include "core/Core.h"
+#include "game/Game.h"
+#include "game/Levels.h"
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+static void printState(const GameState &s) {
+  std::string rows((size_t)s.w * s.h, ' ');
+  for (int y = 0; y < s.h; y++) {
+    for (int x = 0; x < s.w; x++) {
+      char c = ' ';
+      switch (s.at(x, y)) {
+      case T::Floor:
+        c = '=';
+        break;
+      case T::Apple:
+        c = 'A';
+        break;
+      case T::Portal:
+        c = 'P';
+        break;
+      case T::Box:
+        c = '#';
+        break;
+      case T::Trap:
+        c = 'X';
+        break;
+      case T::Void:
+        break;
+      }
+      rows[y * s.w + x] = c;
+    }
+  }
+  int n = (int)s.snake.size();
+  for (int i = n - 1; i >= 0; i--) {
+    V2 p = s.snake[i];
+    if (p.x < 0 || p.x >= s.w || p.y < 0 || p.y >= s.h)
+      continue;
+    rows[p.y * s.w + p.x] = (i == 0) ? 'H' : (i == n - 1 ? 'B' : 'M');
+  }
+
+  printf("+%s+\n", std::string(s.w, '-').c_str());
+  for (int y = 0; y < s.h; y++)
+    printf("|%s|\n", rows.substr((size_t)y * s.w, s.w).c_str());
+  printf("+%s+\n", std::string(s.w, '-').c_str());
+
+  printf("snake:");
+  for (const auto &seg : s.snake)
+    printf(" (%d,%d)", seg.x, seg.y);
+  printf("\nmoves=%d apples=%d len=%d won=%d dead=%d\n", s.moves, s.apples, n,
+         s.won ? 1 : 0, s.dead ? 1 : 0);
+}
+
+int main(int argc, char **argv) {
+  if (argc > 2 && strcmp(argv[1], "-p") == 0) {
+    if (!loadLevelPack(argv[2])) {
+      fprintf(stderr, "%s: not a level pack\n", argv[2]);
+      return 2;
+    }
+    argv += 2;
+    argc -= 2;
+  }
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s [-p pack] <level 1-%d> [moves]\n", argv[0],
+            getNumLevels());
+    return 2;
+  }
+  int level = atoi(argv[1]) - 1;
+  if (level < 0 || level >= getNumLevels()) {
+    fprintf(stderr, "level must be in 1..%d\n", getNumLevels());
+    return 2;
+  }
+
+  GameEngine engine;
+  engine.loadLevel(level);
+  printf("level %d: %s\n", level + 1, getLevelName(level));
+
+  const char *moves = argc > 2 ? argv[2] : "";
+  int applied = 0, rejected = 0;
+  for (const char *m = moves; *m; m++) {
+    V2 dir{0, 0};
+    switch (toupper((unsigned char)*m)) {
+    case 'U':
+      dir = {0, -1};
+      break;
+    case 'D':
+      dir = {0, 1};
+      break;
+    case 'L':
+      dir = {-1, 0};
+      break;
+    case 'R':
+      dir = {1, 0};
+      break;
+    case 'Z':
+      engine.undo();
+      continue;
+    default:
+      continue; // ignore separators
+    }
+    if (engine.doMove(dir))
+      applied++;
+    else
+      rejected++;
+  }
+  printf("applied=%d rejected=%d\n", applied, rejected);
+  printState(engine.getState());
+  return engine.getState().won ? 0 : 1;
+}
@@ -0,0 +1,89 @@
+// snake_pack — builds a binary level pack (see game/LevelPack.h).
+//
+// Usage: snake_pack <out> [levels.txt...]
+//   out         pack file to write
+//   levels.txt  text levels; without any, the built-in levels are packed
+//
+// Text levels are a "level <w> <h> <name>" line followed by h rows in the
+// level characters ('=', 'A', 'P', '#', 'X', H/M/B, ' ' or '.'). Lines
+// starting with ';' outside a level are comments.
+#include "core/Core.h"
+#include "game/LevelPack.h"
+#include "game/Levels.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static bool readTextLevels(const char *path, std::vector<GameState> &levels,
+                           std::vector<std::string> &names) {
+  std::ifstream in(path);
+  if (!in) {
+    fprintf(stderr, "%s: cannot open\n", path);
+    return false;
+  }
+  std::string line;
+  int lineNo = 0;
+  while (std::getline(in, line)) {
+    lineNo++;
+    if (line.empty() || line[0] == ';')
+      continue;
+    std::istringstream hdr(line);
+    std::string word, name;
+    int w = 0, h = 0;
+    hdr >> word >> w >> h;
+    std::getline(hdr >> std::ws, name);
+    if (word != "level" || w <= 0 || h <= 0 || w > MG || h > MG) {
+      fprintf(stderr, "%s:%d: expected 'level <w> <h> <name>' (max %d)\n",
+              path, lineNo, MG);
+      return false;
+    }
+    std::vector<std::string> rows(h);
+    for (int y = 0; y < h; y++) {
+      if (!std::getline(in, rows[y])) {
+        fprintf(stderr, "%s: level '%s' has fewer than %d rows\n", path,
+                name.c_str(), h);
+        return false;
+      }
+      lineNo++;
+      if (!rows[y].empty() && rows[y].back() == '\r')
+        rows[y].pop_back();
+    }
+    const char *ptrs[MG];
+    for (int y = 0; y < h; y++)
+      ptrs[y] = rows[y].c_str();
+    GameState gs;
+    parseLevelRows(ptrs, w, h, gs);
+    levels.push_back(std::move(gs));
+    names.push_back(name);
+  }
+  return true;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <out> [levels.txt...]\n", argv[0]);
+    return 2;
+  }
+  std::vector<GameState> levels;
+  std::vector<std::string> names;
+  if (argc == 2) {
+    for (int i = 0; i < getNumLevels(); i++) {
+      levels.emplace_back();
+      loadLevelData(i, levels.back());
+      names.push_back(getLevelName(i));
+    }
+  }
+  for (int i = 2; i < argc; i++)
+    if (!readTextLevels(argv[i], levels, names))
+      return 1;
+
+  if (!writeLevelPack(argv[1], levels, names)) {
+    fprintf(stderr, "%s: failed to write pack\n", argv[1]);
+    return 1;
+  }
+  printf("%s: %zu levels\n", argv[1], levels.size());
+  return 0;
+}
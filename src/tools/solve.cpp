@@ -0,0 +1,114 @@
+// snake_solve — finds the shortest solution of shipped levels.
+//
+// Usage: snake_solve [-p pack] [-j threads | -a | -i] [-H heuristic]
+//                    [-T bits] [level...]
+//   -p     binary level pack to solve instead of the built-in levels
+//   -j     breadth-first on this many threads (0: one per core)
+//   -a     A* search
+//   -i     IDA* search
+//   -H     heuristic for -a / -i (portal, zero, apples); default portal
+//   -T     IDA* table size as log2 of entries; 0 for O(depth) memory
+//   level  1-based level number; all levels when omitted
+// Without -j, -a or -i the search is a serial breadth-first search.
+//
+// Prints one line per level with the solution (replayable with
+// snake_headless), search size, throughput and peak memory. Exits 0 only if
+// every requested level was solved.
+#include "game/Levels.h"
+#include "solver/Solver.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+int main(int argc, char **argv) {
+  std::vector<int> levels;
+  int threads = -1;
+  char mode = 'b';
+  SolveLimits limits;
+  int numHeuristics;
+  const Heuristic *h = solverHeuristics(numHeuristics);
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+      if (!loadLevelPack(argv[++i])) {
+        fprintf(stderr, "%s: not a level pack\n", argv[i]);
+        return 2;
+      }
+      continue;
+    }
+    if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+      threads = atoi(argv[++i]);
+      mode = 'j';
+      continue;
+    }
+    if (strcmp(argv[i], "-a") == 0 || strcmp(argv[i], "-i") == 0) {
+      mode = argv[i][1];
+      continue;
+    }
+    if (strcmp(argv[i], "-T") == 0 && i + 1 < argc) {
+      limits.idaTableBits = std::min(std::max(atoi(argv[++i]), 0), 30);
+      continue;
+    }
+    if (strcmp(argv[i], "-H") == 0 && i + 1 < argc) {
+      h = findHeuristic(argv[++i]);
+      if (!h) {
+        fprintf(stderr, "unknown heuristic '%s'; one of:", argv[i]);
+        const Heuristic *all = solverHeuristics(numHeuristics);
+        for (int k = 0; k < numHeuristics; k++)
+          fprintf(stderr, " %s", all[k].name);
+        fprintf(stderr, "\n");
+        return 2;
+      }
+      continue;
+    }
+    int level = atoi(argv[i]) - 1;
+    if (level < 0 || level >= getNumLevels()) {
+      fprintf(stderr, "level must be in 1..%d\n", getNumLevels());
+      return 2;
+    }
+    levels.push_back(level);
+  }
+  if (levels.empty())
+    for (int i = 0; i < getNumLevels(); i++)
+      levels.push_back(i);
+
+  int failed = 0;
+  printf("%-3s %-18s %5s %10s %12s %9s %9s  %s\n", "#", "name", "moves",
+         "nodes", "nodes/s", "peak KB", "ms", "solution");
+  for (int level : levels) {
+    BitLevel lv;
+    BitState s;
+    if (!solverLoadLevel(level, lv, s)) {
+      printf("%-3d %-18s %5d %10s %12s %9s %9s  (invalid level)\n",
+             level + 1, getLevelName(level), -1, "-", "-", "-", "-");
+      failed++;
+      continue;
+    }
+    SolveResult r;
+    switch (mode) {
+    case 'j':
+      r = solveBfsParallel(lv, s, threads, limits);
+      break;
+    case 'a':
+      r = solveAStar(lv, s, *h, limits);
+      break;
+    case 'i':
+      r = solveIdaStar(lv, s, *h, limits);
+      break;
+    default:
+      r = solveBfs(lv, s, limits);
+      break;
+    }
+    const SolveStats &st = r.stats;
+    const char *moves = r.solved ? r.moves.c_str()
+                                 : (r.exhausted ? "(unsolvable)" : "(gave up)");
+    printf("%-3d %-18s %5d %10llu %12.0f %9zu %9.2f  %s\n", level + 1,
+           getLevelName(level), r.solved ? (int)r.moves.size() : -1,
+           (unsigned long long)st.nodes, st.nodesPerSec(), st.peakBytes / 1024,
+           st.seconds * 1000.0, moves);
+    if (!r.solved)
+      failed++;
+  }
+  return failed ? 1 : 0;
+}
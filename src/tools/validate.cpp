@@ -0,0 +1,157 @@
+// snake_validate — checks that every level of a pack can be won.
+//
+// Usage: snake_validate [-p pack] [-j threads] [-s bfs|astar|ida]
+//                       [-n maxNodes]
+//   -p     binary level pack; the built-in levels when omitted
+//   -j     levels solved at once (0, the default: one per core)
+//   -s     search used per level; default astar (shortest, portal heuristic)
+//   -n     per-level search budget in nodes
+//
+// Writes a JSON report to stdout, one object per level in level order:
+//   status    "solved", "unsolvable" (every reachable state visited),
+//             "gave_up" (budget exhausted), "mismatch" (the solution did
+//             not win when replayed through GameEngine) or "invalid" (the
+//             level could not be loaded; not searched)
+//   moves     optimal move count (-1 unless solved), solution  U/D/L/R
+//   nodes, expanded, ms, peak_bytes   search statistics
+// A summary goes to stderr. Exits 0 only if every level was solved.
+#include "game/Game.h"
+#include "game/Levels.h"
+#include "solver/Solver.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct Report {
+  const char *status = "gave_up";
+  SolveResult r;
+};
+
+// Plays the solution through GameEngine, the same path as interactive play
+static bool replayWins(int level, const std::string &moves) {
+  GameEngine engine;
+  engine.loadLevel(level);
+  for (char c : moves) {
+    V2 dir = c == 'U' ? V2{0, -1}
+             : c == 'D' ? V2{0, 1}
+             : c == 'L' ? V2{-1, 0}
+                        : V2{1, 0};
+    if (!engine.doMove(dir))
+      return false;
+  }
+  return engine.getState().won;
+}
+
+static void printJsonString(const char *s) {
+  putchar('"');
+  for (; *s; s++) {
+    unsigned char c = (unsigned char)*s;
+    if (c == '"' || c == '\\')
+      printf("\\%c", c);
+    else if (c < 0x20)
+      printf("\\u%04x", c);
+    else
+      putchar(c);
+  }
+  putchar('"');
+}
+
+int main(int argc, char **argv) {
+  int threads = 0;
+  const char *search = "astar";
+  SolveLimits limits;
+  for (int i = 1; i < argc; i++) {
+    bool more = i + 1 < argc;
+    if (strcmp(argv[i], "-p") == 0 && more) {
+      if (!loadLevelPack(argv[++i])) {
+        fprintf(stderr, "%s: not a level pack\n", argv[i]);
+        return 2;
+      }
+    } else if (strcmp(argv[i], "-j") == 0 && more) {
+      threads = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-s") == 0 && more) {
+      search = argv[++i];
+    } else if (strcmp(argv[i], "-n") == 0 && more) {
+      limits.maxNodes = strtoull(argv[++i], nullptr, 10);
+    } else {
+      fprintf(stderr,
+              "usage: %s [-p pack] [-j threads] [-s bfs|astar|ida] "
+              "[-n maxNodes]\n",
+              argv[0]);
+      return 2;
+    }
+  }
+  if (strcmp(search, "bfs") && strcmp(search, "astar") &&
+      strcmp(search, "ida")) {
+    fprintf(stderr, "unknown search '%s'\n", search);
+    return 2;
+  }
+  if (threads <= 0)
+    threads = (int)std::max(1u, std::thread::hardware_concurrency());
+
+  int count = getNumLevels();
+  int numHeuristics;
+  const Heuristic &h = solverHeuristics(numHeuristics)[0];
+  std::vector<Report> reports(count);
+  std::atomic<int> nextLevel{0};
+  auto worker = [&]() {
+    for (int i; (i = nextLevel.fetch_add(1)) < count;) {
+      BitLevel lv;
+      BitState s;
+      Report &rep = reports[i];
+      if (!solverLoadLevel(i, lv, s)) {
+        rep.status = "invalid";
+        continue;
+      }
+      if (search[0] == 'b')
+        rep.r = solveBfs(lv, s, limits);
+      else if (search[0] == 'a')
+        rep.r = solveAStar(lv, s, h, limits);
+      else
+        rep.r = solveIdaStar(lv, s, h, limits);
+      if (rep.r.solved)
+        rep.status = replayWins(i, rep.r.moves) ? "solved" : "mismatch";
+      else if (rep.r.exhausted)
+        rep.status = "unsolvable";
+    }
+  };
+
+  auto t0 = std::chrono::steady_clock::now();
+  std::vector<std::thread> pool;
+  for (int t = 1; t < std::min(threads, count); t++)
+    pool.emplace_back(worker);
+  worker();
+  for (auto &t : pool)
+    t.join();
+  double secs =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - t0)
+          .count();
+
+  int solved = 0;
+  printf("[\n");
+  for (int i = 0; i < count; i++) {
+    const Report &rep = reports[i];
+    const SolveStats &st = rep.r.stats;
+    bool ok = strcmp(rep.status, "solved") == 0;
+    solved += ok;
+    printf("  {\"level\": %d, \"name\": ", i + 1);
+    printJsonString(getLevelName(i));
+    printf(", \"status\": \"%s\", \"moves\": %d, \"solution\": \"%s\", "
+           "\"nodes\": %llu, \"expanded\": %llu, \"ms\": %.3f, "
+           "\"peak_bytes\": %zu}%s\n",
+           rep.status, ok ? (int)rep.r.moves.size() : -1,
+           ok ? rep.r.moves.c_str() : "", (unsigned long long)st.nodes,
+           (unsigned long long)st.expanded, st.seconds * 1000.0, st.peakBytes,
+           i + 1 < count ? "," : "");
+  }
+  printf("]\n");
+  fprintf(stderr, "%d/%d levels solved in %.2f s (%s, %d threads)\n", solved,
+          count, secs, search, threads);
+  return solved == count ? 0 : 1;
+}